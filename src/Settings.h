@@ -9,11 +9,28 @@ enum ShapeType {
     SHAPE_CYLINDER
 };
 
+// How the viewer draws the terrain
+enum RenderMode {
+    RENDER_MESH, // the generated mesh, uploaded whole
+    RENDER_LOD,  // CDLOD chunks, selected every frame from the camera
+    RENDER_PLANET, // a cube-sphere planet in chunked LOD, with the camera in orbit around it
+    RENDER_HEIGHTMAP, // the terrain's heightfield as a texture, displacing one shared grid on the GPU
+    RENDER_TESSELLATED_TERRAIN, // the terrain's noise evaluated in tessellation shaders over a coarse patch grid
+    RENDER_TESSELLATED_PLANET,  // the planet likewise, over coarse cube-sphere patches
+    RENDER_CLIPMAP,             // nested grids around a camera that travels over the unbounded terrain
+    RENDER_STREAM               // equal chunks streamed in on worker threads around a travelling camera
+};
+
 struct Settings {
     int shapeType;
     int shapeParameter1 = 1;
     int shapeParameter2 = 1;
     bool showWireframeNormals = true;
+    int workerThreads = 0; // mesh generation threads, 0 = one per hardware thread
+    int octaves = 4;       // octaves of fractal noise in the terrain height
+    bool compactVertices = false; // upload 8-byte CompactVertex instead of 6 floats per vertex
+    int renderMode = RENDER_MESH;
+    int lodExtent = 0;     // the LOD terrain is 10 * 2^lodExtent units across
 };
 
 
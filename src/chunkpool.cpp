@@ -0,0 +1,90 @@
+#include "chunkpool.h"
+
+void ChunkPool::create(GLsizeiptr slotBytes, int initialSlots, AttributeSetup setupAttributes)
+{
+    initializeOpenGLFunctions();
+    m_slotBytes = slotBytes;
+    m_setupAttributes = setupAttributes;
+    m_slotCount = 0;
+    m_freeSlots.clear();
+    m_chunks.clear();
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    glBufferData(GL_ARRAY_BUFFER, initialSlots * slotBytes, nullptr, GL_DYNAMIC_DRAW);
+    m_setupAttributes(this);
+    m_slotCount = initialSlots;
+    clear();
+}
+
+void ChunkPool::destroy()
+{
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+    m_slotCount = 0;
+    m_freeSlots.clear();
+    m_chunks.clear();
+}
+
+void ChunkPool::clear()
+{
+    m_chunks.clear();
+    m_freeSlots.clear();
+    for (int slot = m_slotCount - 1; slot >= 0; slot--) m_freeSlots.push_back(slot);
+}
+
+// Doubles the buffer, keeping the chunks already in it
+void ChunkPool::grow()
+{
+    int count = 2 * m_slotCount;
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, count * m_slotBytes, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, 0, 0, m_slotCount * m_slotBytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = buffer;
+    m_setupAttributes(this);
+
+    for (int slot = count - 1; slot >= m_slotCount; slot--) m_freeSlots.push_back(slot);
+    m_slotCount = count;
+}
+
+int ChunkPool::find(uint64_t key)
+{
+    auto it = m_chunks.find(key);
+    if (it == m_chunks.end()) return -1;
+    it->second.lastUsed = m_frame;
+    return it->second.slot;
+}
+
+// A free slot, or the least recently used chunk's if it was not used this frame
+int ChunkPool::insert(uint64_t key)
+{
+    if (m_freeSlots.empty()) {
+        auto oldest = m_chunks.end();
+        for (auto it = m_chunks.begin(); it != m_chunks.end(); ++it) {
+            if (it->second.lastUsed < m_frame &&
+                (oldest == m_chunks.end() || it->second.lastUsed < oldest->second.lastUsed)) {
+                oldest = it;
+            }
+        }
+        if (oldest != m_chunks.end()) {
+            m_freeSlots.push_back(oldest->second.slot);
+            m_chunks.erase(oldest);
+        } else {
+            grow();
+        }
+    }
+    int slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    m_chunks[key] = Chunk{slot, m_frame};
+    return slot;
+}
+
+void ChunkPool::upload(int slot, const void *data)
+{
+    glBufferSubData(GL_ARRAY_BUFFER, slot * m_slotBytes, m_slotBytes, data);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <QOpenGLFunctions_4_1_Core>
+
+// Fixed-size vertex slots in one GL buffer, for LOD renderers that draw many same-sized chunks.
+//
+// Chunks are looked up by a 64-bit key. A chunk keeps its slot while it stays in use; when a new one
+// needs room, the least recently used chunk that was not used this frame gives up its slot, and only
+// when every chunk is in use does the buffer double (copied on the GPU, so resident chunks survive).
+// Needs a current GL context throughout.
+class ChunkPool : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    // Points the bound VAO's attributes at the bound buffer; called again whenever the buffer changes
+    using AttributeSetup = void (*)(QOpenGLFunctions_4_1_Core *gl);
+
+    // Allocates `initialSlots` slots of `slotBytes` each. The VAO the attributes belong to must be bound.
+    void create(GLsizeiptr slotBytes, int initialSlots, AttributeSetup setupAttributes);
+    void destroy();
+    // Frees every slot, keeping the buffer
+    void clear();
+
+    GLuint bufferId() const { return m_buffer; }
+    int slotCount() const { return m_slotCount; }
+    int residentCount() const { return int(m_chunks.size()); }
+
+    // Starts a frame: chunks used from here on are safe from eviction until the next one
+    void beginFrame() { m_frame++; }
+    // Slot of the chunk `key`, marked used this frame, or -1 if it is not resident
+    int find(uint64_t key);
+    // A slot for the new chunk `key`, marked used this frame. The VAO and the buffer must be bound;
+    // the buffer may be replaced by a larger one.
+    int insert(uint64_t key);
+    // Writes one slot's worth of `data` into `slot`. The buffer must be bound to GL_ARRAY_BUFFER.
+    void upload(int slot, const void *data);
+
+private:
+    struct Chunk
+    {
+        int slot;
+        uint64_t lastUsed; // frame it was last used in
+    };
+
+    void grow();
+
+    AttributeSetup m_setupAttributes = nullptr;
+    GLsizeiptr m_slotBytes = 0;
+    GLuint m_buffer = 0;
+    int m_slotCount = 0;
+    std::vector<int> m_freeSlots;
+    std::unordered_map<uint64_t, Chunk> m_chunks;
+    uint64_t m_frame = 0;
+};
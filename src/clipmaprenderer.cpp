@@ -0,0 +1,217 @@
+#include "clipmaprenderer.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <QOpenGLShaderProgram>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+
+#include "vertexattributes.h"
+
+// Each level blends into the next coarser one over this many of its quads, finishing one quad inside
+// the nearest its edge can come to the camera (kGridSize / 2 - 2 quads)
+static constexpr int kMorphWidth = Clipmap::kGridSize / 8;
+static constexpr int kMorphEnd = Clipmap::kGridSize / 2 - 3;
+
+static const char *clipmapVertexShaderSource =
+    "layout(location = 0) in vec2 gridPos;\n"
+    "out vec3 vert;\n"
+    "out vec3 vertNormal;\n"
+    "uniform sampler2DArray heights;\n"
+    "uniform int level;\n"
+    "uniform ivec2 wrapOrigin;\n"   // the level's low corner in its toroidal layer
+    "uniform vec3 offset;\n"        // the level's low corner relative to the ground below the camera
+    "uniform float spacing;\n"
+    "uniform float morphStart;\n"   // quads from the centre where the blend into the coarser level begins
+    "uniform float morphWidth;\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform mat4 mvMatrix;\n"
+    "uniform mat3 normalMatrix;\n"
+    "float heightAt(ivec2 g) { return texelFetch(heights, ivec3((wrapOrigin + g) % SIDE, level), 0).r; }\n"
+    "void main() {\n"
+    "   ivec2 g = ivec2(gridPos);\n"
+    "   float h = heightAt(g);\n"
+    // The coarser level's surface here: its samples are this level's even ones, and its quads are
+    // split as Terrain::makeTile(), top left to bottom right
+    "   ivec2 odd = g & 1;\n"
+    "   float coarse = h;\n"
+    "   if (odd.x == 1 && odd.y == 1) coarse = 0.5 * (heightAt(g + ivec2(-1, 1)) + heightAt(g + ivec2(1, -1)));\n"
+    "   else if (odd.x == 1) coarse = 0.5 * (heightAt(g - ivec2(1, 0)) + heightAt(g + ivec2(1, 0)));\n"
+    "   else if (odd.y == 1) coarse = 0.5 * (heightAt(g - ivec2(0, 1)) + heightAt(g + ivec2(0, 1)));\n"
+    "   vec2 xy = offset.xy + vec2(g) * spacing;\n"
+    "   float alpha = clamp((max(abs(xy.x), abs(xy.y)) / spacing - morphStart) / morphWidth, 0.0, 1.0);\n"
+    // Central differences, one-sided along the grid's edges
+    "   ivec2 lo = max(g - 1, 0), hi = min(g + 1, SIDE - 1);\n"
+    "   float dx = (heightAt(ivec2(hi.x, g.y)) - heightAt(ivec2(lo.x, g.y))) / (float(hi.x - lo.x) * spacing);\n"
+    "   float dy = (heightAt(ivec2(g.x, hi.y)) - heightAt(ivec2(g.x, lo.y))) / (float(hi.y - lo.y) * spacing);\n"
+    "   vert = vec3(mvMatrix * vec4(xy, offset.z + mix(h, coarse, alpha), 1.0));\n"
+    "   vertNormal = normalMatrix * normalize(vec3(-dx, -dy, 1.0));\n"
+    "   gl_Position = projMatrix * vec4(vert, 1.0);\n"
+    "}\n";
+
+void ClipmapRenderer::create()
+{
+    initializeOpenGLFunctions();
+
+    std::string vertexSource = "#version 330 core\n#define SIDE " + std::to_string(Clipmap::kSide) + "\n" +
+                               clipmapVertexShaderSource;
+    m_program = new QOpenGLShaderProgram;
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource.c_str());
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, glslSource({shadeSource, pointLitFragmentSource}).c_str());
+    m_program->link();
+    m_program->bind();
+    m_program->setUniformValue("heights", 0);
+    m_program->setUniformValue("morphStart", float(kMorphEnd - kMorphWidth));
+    m_program->setUniformValue("morphWidth", float(kMorphWidth));
+    m_program->setUniformValue("lightPos", QVector3D(70, 70, 70));
+    m_program->release();
+
+    const int side = Clipmap::kSide, grid = Clipmap::kGridSize;
+    std::vector<unsigned char> vertices(size_t(side) * side * ClipmapVertexFormat::stride);
+    MeshWriter<ClipmapVertexFormat> writer(vertices.data(), side * side);
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) writer.write(y * side + x, glm::u16vec2(x, y));
+    }
+
+    // The full grid, then one ring per hole position; quads split as Terrain::makeTile()
+    std::vector<uint16_t> indices;
+    auto range = [&](int index, int holeX, int holeY) {
+        m_rangeStart[index] = GLsizei(indices.size());
+        for (int y = 0; y < grid; y++) {
+            for (int x = 0; x < grid; x++) {
+                bool hole = holeX >= 0 && x >= holeX && x < holeX + grid / 2 && y >= holeY && y < holeY + grid / 2;
+                if (hole) continue;
+                uint16_t bottomLeft = uint16_t(y * side + x), bottomRight = bottomLeft + 1;
+                uint16_t topLeft = uint16_t(bottomLeft + side), topRight = topLeft + 1;
+                indices.insert(indices.end(), {topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight});
+            }
+        }
+        m_rangeCount[index] = GLsizei(indices.size()) - m_rangeStart[index];
+    };
+    range(0, -1, -1);
+    for (int k = 0; k < 4; k++) range(1 + k, grid / 4 + (k & 1), grid / 4 + (k >> 1));
+
+    m_vao.create();
+    m_vao.bind();
+    glGenBuffers(1, &m_vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertices.size()), vertices.data(), GL_STATIC_DRAW);
+    setVertexAttributes<ClipmapVertexFormat>(this);
+    glGenBuffers(1, &m_indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indices.size() * sizeof(uint16_t)), indices.data(), GL_STATIC_DRAW);
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, side, side, kLevels, 0, GL_RED, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    m_configured = false;
+}
+
+void ClipmapRenderer::destroy()
+{
+    delete m_program;
+    m_program = nullptr;
+    glDeleteBuffers(1, &m_vertexBuffer);
+    glDeleteBuffers(1, &m_indexBuffer);
+    glDeleteTextures(1, &m_texture);
+    m_vertexBuffer = m_indexBuffer = m_texture = 0;
+    m_vao.destroy();
+}
+
+void ClipmapRenderer::configure(int octaves)
+{
+    if (m_configured && octaves == m_clipmap.octaves()) return;
+    m_clipmap.configure(kLevels, kSpacing, octaves);
+    m_configured = true;
+}
+
+double ClipmapRenderer::reach() const
+{
+    return Clipmap::kGridSize / 2 * kSpacing * std::exp2(kLevels - 1);
+}
+
+// Copies whatever the Clipmap evaluated since the last upload into the texture
+void ClipmapRenderer::upload()
+{
+    const int side = Clipmap::kSide;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, side);
+    for (int l = 0; l < m_clipmap.levelCount(); l++) {
+        const Clipmap::Level &level = m_clipmap.level(l);
+        const float *heights = level.heights.data();
+        if (level.dirtyAll) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, l, side, side, 1, GL_RED, GL_FLOAT, heights);
+            continue;
+        }
+        for (int column : level.dirtyColumns) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, column, 0, l, 1, side, 1, GL_RED, GL_FLOAT, heights + column);
+        }
+        for (int row : level.dirtyRows) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, row, l, side, 1, 1, GL_RED, GL_FLOAT, heights + size_t(row) * side);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    m_clipmap.clearDirty();
+}
+
+void ClipmapRenderer::render(const glm::mat4 &proj, const glm::mat4 &modelView, const glm::dvec2 &center, bool wireframe)
+{
+    m_clipmap.update(center);
+    upload();
+
+    m_vao.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    m_program->bind();
+    m_program->setUniformValue("projMatrix", toQMatrix(proj));
+    m_program->setUniformValue("mvMatrix", toQMatrix(modelView));
+    m_program->setUniformValue("normalMatrix", toQMatrix(modelView).normalMatrix());
+
+    // The finest level's nearest sample stands in for the ground below the camera
+    const Clipmap::Level &finest = m_clipmap.level(0);
+    float ground = m_clipmap.height(0, int64_t(std::floor(center.x / finest.spacing + 0.5)),
+                                    int64_t(std::floor(center.y / finest.spacing + 0.5)));
+
+    int passes = wireframe ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        bool lines = pass == 1;
+        m_program->setUniformValue("wireframe", lines);
+        glPolygonMode(GL_FRONT_AND_BACK, lines ? GL_LINE : GL_FILL);
+        if (lines) {
+            glEnable(GL_POLYGON_OFFSET_LINE);
+            glPolygonOffset(-1, -1);
+        }
+        for (int l = 0; l < m_clipmap.levelCount(); l++) {
+            const Clipmap::Level &level = m_clipmap.level(l);
+            int range = 0;
+            if (l > 0) {
+                glm::ivec2 hole = m_clipmap.holeOffset(l) - Clipmap::kGridSize / 4;
+                range = 1 + hole.x + 2 * hole.y;
+            }
+            // The offset is formed in double, so it stays exact however far the camera has travelled
+            glm::dvec2 offset = glm::dvec2(double(level.x0), double(level.y0)) * level.spacing - center;
+            m_program->setUniformValue("level", l);
+            glUniform2i(m_program->uniformLocation("wrapOrigin"), Clipmap::wrap(level.x0), Clipmap::wrap(level.y0));
+            m_program->setUniformValue("offset", QVector3D(float(offset.x), float(offset.y), -ground));
+            m_program->setUniformValue("spacing", float(level.spacing));
+            glDrawElements(GL_TRIANGLES, m_rangeCount[range], GL_UNSIGNED_SHORT,
+                           reinterpret_cast<void *>(size_t(m_rangeStart[range]) * sizeof(uint16_t)));
+        }
+    }
+    glDisable(GL_POLYGON_OFFSET_LINE);
+    glPolygonOffset(0, 0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    m_program->release();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    m_vao.release();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLVertexArrayObject>
+
+#include "lod/Clipmap.h"
+#include "shapes/VertexFormat.h"
+
+QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
+
+// Grid vertex (column, row) of a clipmap level
+using ClipmapVertexFormat = VertexFormat<Attribute<uint16_t, 2>>;
+
+// Draws a Clipmap around a camera that travels over the unbounded terrain.
+//
+// Each level's heights are one layer of an R32F array texture, addressed toroidally like the Clipmap's
+// buffers, so a frame uploads only the rows and columns the Clipmap just evaluated. All levels share one
+// grid of vertices: the finest draws all of it, every other level a ring around the level inside it,
+// with the index range picked by Clipmap::holeOffset(). Towards its outer edge each level's heights
+// blend into the next coarser level's, reaching it exactly on the edge, so rings meet without cracks.
+// Vertices are placed relative to the ground below the camera, so precision does not drop far from the origin.
+// Needs a current GL context throughout.
+class ClipmapRenderer : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    static constexpr int kLevels = 10;
+    // Finest quad size; the coarsest level then spans 128 * 0.05 * 2^9, about 3.3 km
+    static constexpr double kSpacing = 0.05;
+
+    void create();
+    void destroy();
+
+    // Any change of `octaves` re-evaluates every level
+    void configure(int octaves);
+    const Clipmap &clipmap() const { return m_clipmap; }
+    // Half the coarsest level's side: nothing is drawn beyond it
+    double reach() const;
+
+    // `modelView` maps terrain coordinates relative to the ground below `center` (z up) to the eye
+    void render(const glm::mat4 &proj, const glm::mat4 &modelView, const glm::dvec2 &center, bool wireframe);
+
+private:
+    void upload();
+
+    Clipmap m_clipmap;
+    bool m_configured = false;
+
+    QOpenGLShaderProgram *m_program = nullptr;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_vertexBuffer = 0;
+    GLuint m_indexBuffer = 0;
+    GLuint m_texture = 0;
+    // Index ranges: the full grid, then rings for hole offsets (dx, dy) - kGridSize / 4 = (0, 0), (1, 0), (0, 1), (1, 1)
+    GLsizei m_rangeStart[5] = {};
+    GLsizei m_rangeCount[5] = {};
+};
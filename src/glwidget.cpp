@@ -3,42 +3,54 @@
 
 #include <QOpenGLShaderProgram>
 #include <QCoreApplication>
+#include <QMetaObject>
 #include <math.h>
+#include <cstddef>
+#include <algorithm>
 #include <iostream>
+#include <string>
 #include "glm/gtx/transform.hpp"
 #include "shapes/Terrain.h"
+#include "vertexattributes.h"
 
 /**
  * ==================================================
- *                  Shape Shaders
+ *                  Vertex Inputs
  * ==================================================
  */
-static const char *vertexShaderSourceCore =
-    "#version 330 core\n"
+// Prepended to every vertex shader, after the version line. position() and normalVector() hide the
+// vertex layout: 6 floats, or CompactVertex (unorm16 position in the posScale / posBias box,
+// octahedral snorm8 normal) when COMPACT_VERTICES is defined.
+static const char *vertexInputSourceCore =
+    "#ifdef COMPACT_VERTICES\n"
+    "layout(location = 0) in vec3 vertex;\n"
+    "layout(location = 1) in vec2 octNormal;\n"
+    "uniform vec3 posScale;\n"
+    "uniform vec3 posBias;\n"
+    "vec4 position() { return vec4(posBias + posScale * vertex, 1.0); }\n"
+    "vec3 normalVector() { return octDecode(octNormal); }\n"
+    "#else\n"
     "layout(location = 0) in vec4 vertex;\n"
     "layout(location = 1) in vec3 normal;\n"
+    "vec4 position() { return vertex; }\n"
+    "vec3 normalVector() { return normal; }\n"
+    "#endif\n";
+
+/**
+ * ==================================================
+ *                  Shape Shaders
+ * ==================================================
+ */
+static const char *vertexShaderSourceCore =
     "out vec3 vert;\n"
     "out vec3 vertNormal;\n"
     "uniform mat4 projMatrix;\n"
     "uniform mat4 mvMatrix;\n"
     "uniform mat3 normalMatrix;\n"
     "void main() {\n"
-    "   vert = vec3(mvMatrix * vertex);;\n"
-    "   vertNormal = normalMatrix * normal;\n"
-    "   gl_Position = projMatrix * mvMatrix * vertex;\n"
-    "}\n";
-static const char *fragmentShaderSourceCore =
-    "#version 330 core\n"
-    "in vec3 vert;\n"
-    "in vec3 vertNormal;\n"
-    "out vec4 fragColor;\n"
-    "uniform vec3 lightPos;\n"
-    "void main() {\n"
-    "   vec3 L = normalize(lightPos - vert);\n"
-    "   float NL = max(dot(normalize(vertNormal), L), 0.0);\n"
-    "   vec3 color = vec3(1.0, 0.78, 0.0);\n"
-    "   vec3 col = clamp(color * 0.2 + color * 0.8 * NL, 0.0, 1.0);\n"
-    "   fragColor = vec4(col, 1.0);\n"
+    "   vert = vec3(mvMatrix * position());\n"
+    "   vertNormal = normalMatrix * normalVector();\n"
+    "   gl_Position = projMatrix * mvMatrix * position();\n"
     "}\n";
 
 /**
@@ -47,14 +59,11 @@ static const char *fragmentShaderSourceCore =
  * ==================================================
  */
 static const char *wireframeVertexShaderSourceCore =
-    "#version 330 core\n"
-    "layout(location = 0) in vec4 vertex;\n"
-    "layout(location = 1) in vec3 normal;\n"
     "uniform mat4 projMatrix;\n"
     "uniform mat4 mvMatrix;\n"
     "uniform mat3 normalMatrix;\n"
     "void main() {\n"
-    "   gl_Position = projMatrix * mvMatrix * vertex;\n"
+    "   gl_Position = projMatrix * mvMatrix * position();\n"
     "}\n";
 static const char *wireframeFragmentShaderSourceCore =
     "#version 330 core\n"
@@ -70,13 +79,10 @@ static const char *wireframeFragmentShaderSourceCore =
  */
 /// ~~~ Arrow Body ~~~
 static const char *normalsVertexShaderSourceCore =
-    "#version 330 core\n"
-    "layout(location = 0) in vec4 vertex;\n"
-    "layout(location = 1) in vec3 normal;\n"
     "out vec4 vertNormal;\n"
     "void main() {\n"
-    "   gl_Position = vertex;\n"
-    "   vertNormal = vec4(normal, 0.0);\n"
+    "   gl_Position = position();\n"
+    "   vertNormal = vec4(normalVector(), 0.0);\n"
     "}\n";
 static const char *normalsGeometryShaderSourceCore =
     "#version 330 core\n"
@@ -107,13 +113,10 @@ static const char *normalsFragmentShaderSourceCore =
 
 /// ~~~ Arrow Head ~~~
 static const char *normalsTipVertexShaderSourceCore =
-    "#version 330 core\n"
-    "layout(location = 0) in vec4 vertex;\n"
-    "layout(location = 1) in vec3 normal;\n"
     "out vec4 vertNormal;\n"
     "void main() {\n"
-    "   gl_Position = vertex;\n"
-    "   vertNormal = vec4(normal, 0.0);\n"
+    "   gl_Position = position();\n"
+    "   vertNormal = vec4(normalVector(), 0.0);\n"
     "}\n";
 static const char *normalsTipGeometryShaderSourceCore =
     "#version 330 core\n"
@@ -149,15 +152,22 @@ static const char *normalsTipFragmentShaderSourceCore =
     "    fragColor = vec4(vec3(0.0), 1.0);\n"
     "}\n";
 
-void GLWidget::initializeGL()
+// A vertex shader body with the version line, octDecode() and the vertex inputs for the given layout in front
+static std::string vertexShader(const char *body, bool compactVertices)
 {
-    initializeOpenGLFunctions();
-    glClearColor(103/255.f, 142/255.f, 166/255.f, 1); // set the background color
+    std::string source = "#version 330 core\n";
+    if (compactVertices) source += "#define COMPACT_VERTICES\n";
+    return source + octDecodeSource + vertexInputSourceCore + body;
+}
+
+void GLWidget::createPrograms(bool compactVertices)
+{
+    m_programsCompact = compactVertices;
 
     // Create Shapes shader program
     m_program = new QOpenGLShaderProgram; // allow OpenGL shader programs to be linked and used
-    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSourceCore);
-    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSourceCore);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader(vertexShaderSourceCore, compactVertices));
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, glslSource({shadeSource, pointLitFragmentSource}).c_str());
     m_program->link();
     m_program->bind();
     m_default_projLoc = m_program->uniformLocation("projMatrix");
@@ -169,7 +179,7 @@ void GLWidget::initializeGL()
 
     // Create Wireframe shader program
     m_wireframeProgram = new QOpenGLShaderProgram;
-    m_wireframeProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, wireframeVertexShaderSourceCore);
+    m_wireframeProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader(wireframeVertexShaderSourceCore, compactVertices));
     m_wireframeProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, wireframeFragmentShaderSourceCore);
     m_wireframeProgram->link();
     m_wireframeProgram->bind();
@@ -179,7 +189,7 @@ void GLWidget::initializeGL()
 
     // Create Normals shader program
     m_normalsProgram = new QOpenGLShaderProgram; // arrow body
-    m_normalsProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, normalsVertexShaderSourceCore);
+    m_normalsProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader(normalsVertexShaderSourceCore, compactVertices));
     m_normalsProgram->addShaderFromSourceCode(QOpenGLShader::Geometry, normalsGeometryShaderSourceCore);
     m_normalsProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, normalsFragmentShaderSourceCore);
     m_normalsProgram->link();
@@ -189,7 +199,7 @@ void GLWidget::initializeGL()
     m_normalsProgram->release();
 
     m_normalsTipsProgram = new QOpenGLShaderProgram; // arrow head
-    m_normalsTipsProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, normalsTipVertexShaderSourceCore);
+    m_normalsTipsProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader(normalsTipVertexShaderSourceCore, compactVertices));
     m_normalsTipsProgram->addShaderFromSourceCode(QOpenGLShader::Geometry, normalsTipGeometryShaderSourceCore);
     m_normalsTipsProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, normalsTipFragmentShaderSourceCore);
     m_normalsTipsProgram->link();
@@ -197,81 +207,317 @@ void GLWidget::initializeGL()
     m_normalTip_projLoc = m_normalsTipsProgram->uniformLocation("projMatrix");
     m_normalTip_mvLoc = m_normalsTipsProgram->uniformLocation("mvMatrix");
     m_normalsTipsProgram->release();
+}
 
-    // VAO/VBO stuff
+void GLWidget::destroyPrograms()
+{
+    delete m_program;
+    delete m_wireframeProgram;
+    delete m_normalsProgram;
+    delete m_normalsTipsProgram;
+    m_program = m_wireframeProgram = m_normalsProgram = m_normalsTipsProgram = nullptr;
+}
+
+void GLWidget::bindProgram(QOpenGLShaderProgram *program)
+{
+    program->bind();
+    if (m_programsCompact) {
+        // The compact positions are relative to the current mesh's bounding box
+        glm::vec3 scale = m_compactBounds.scale, bias = m_compactBounds.bias;
+        program->setUniformValue("posScale", QVector3D(scale.x, scale.y, scale.z));
+        program->setUniformValue("posBias", QVector3D(bias.x, bias.y, bias.z));
+    }
+}
+
+void GLWidget::initializeGL()
+{
+    initializeOpenGLFunctions();
+    glClearColor(103/255.f, 142/255.f, 166/255.f, 1); // set the background color
+
+    createPrograms(m_compactVertices);
+
+    // VAO and ring buffers. The attribute layout is only specified again when the vertex format
+    // changes: every mesh is drawn with a base vertex into the same buffer, and the element array
+    // binding is part of the VAO.
     m_vao.create();
     m_vao.bind();
-    m_vbo.create();
-    bindVbo();
+    m_vertexRing.create(GL_ARRAY_BUFFER, 32 << 20);
+    setVertexFormat(m_compactVertices);
+    m_indexRing.create(GL_ELEMENT_ARRAY_BUFFER, 16 << 20);
     m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_lod.create();
+    m_planet.create();
+    m_heightmap.create();
+    m_tessellation.create();
+    m_clipmap.create();
+    m_stream.create();
+    setFocusPolicy(Qt::StrongFocus); // for moving over the unbounded terrain
 
     // m_camera is the model-view matrix. The projection matrix is separately tracked as m_proj
     m_camera = glm::translate(m_camera, glm::vec3(0, 0, -4 + m_zoomZ)); // Camera stuff (facing -z direction)
 }
 
-void GLWidget::bindVbo()
+void GLWidget::setVertexFormat(bool compact)
+{
+    m_compactVertices = compact;
+    if (compact) {
+        setVertexAttributes<CompactVertexFormat>(this);
+    } else {
+        setVertexAttributes<MeshVertexFormat>(this);
+    }
+}
+
+void GLWidget::bindVbo(const Mesh &mesh)
+{
+    // Stream the finished shape into the rings next to the one on screen, then fence the old ranges
+    // so their space is reused once the draws reading them have finished
+    bool compact = settings.compactVertices;
+    StreamBuffer::Range oldVertices = m_vertexRange;
+    StreamBuffer::Range oldIndices = m_indexRange;
+    GLsizeiptr vertexStride = compact ? CompactVertexFormat::stride : MeshVertexFormat::stride;
+    GLsizeiptr indexSize = mesh.wideIndices() ? sizeof(uint32_t) : sizeof(uint16_t);
+
+    m_vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexRing.bufferId());
+    if (compact != m_compactVertices) setVertexFormat(compact);
+
+    bool uploaded = false;
+    if (mesh.indexCount() > 0 && compact) {
+        // Encoded straight into the mapped range, never staged in a CPU buffer
+        m_compactBounds = compactBounds(mesh);
+        void *dst = m_vertexRing.map(mesh.vertexCount() * vertexStride, vertexStride, m_vertexRange);
+        if (dst) {
+            writeCompactVertices(mesh, m_compactBounds, static_cast<CompactVertex *>(dst));
+            uploaded = m_vertexRing.unmap();
+        }
+    } else if (mesh.indexCount() > 0) {
+        uploaded = m_vertexRing.upload(mesh.vertices.data(), GLsizeiptr(mesh.vertexBytes()), vertexStride, m_vertexRange);
+    }
+    uploaded = uploaded &&
+        m_indexRing.upload(mesh.indexData(), GLsizeiptr(mesh.indexBytes()), indexSize, m_indexRange);
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_vertexRing.retire(oldVertices);
+    m_indexRing.retire(oldIndices);
+    if (!uploaded) {
+        // Nothing to draw; the old ranges may have been discarded to make room
+        m_vertexRing.retire(m_vertexRange);
+        m_indexRing.retire(m_indexRange);
+        m_numIndices = 0;
+        m_meshChunks.clear();
+        return;
+    }
+
+    m_numIndices = mesh.indexCount();
+    m_meshChunks = mesh.chunks;
+    m_indexType = mesh.wideIndices() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    m_baseVertex = GLint(m_vertexRange.offset / vertexStride);
+}
+
+// Leaves out the mesh's chunks outside the view or facing away from the camera, joining the indices of
+// the rest into as few runs as their order allows. A mesh without chunks is drawn whole.
+void GLWidget::cullMesh()
+{
+    m_drawRuns.clear();
+    if (m_numIndices == 0) return;
+    if (m_meshChunks.empty()) {
+        m_drawRuns.push_back({0, m_numIndices});
+        return;
+    }
+
+    glm::mat4 modelView = m_camera * m_world;
+    glm::vec3 eye = glm::inverse(modelView)[3];
+    m_meshChunks.cull(m_proj * modelView, eye, m_chunkVisible);
+    for (int c = 0; c < m_meshChunks.count(); c++) {
+        if (!m_chunkVisible[c]) continue;
+        int first = m_meshChunks.firstIndex[c], count = m_meshChunks.indexCount[c];
+        if (!m_drawRuns.empty() && m_drawRuns.back().first + m_drawRuns.back().count == first) {
+            m_drawRuns.back().count += count;
+        } else {
+            m_drawRuns.push_back({first, count});
+        }
+    }
+}
+
+void GLWidget::drawMesh()
+{
+    GLsizeiptr indexSize = m_indexType == GL_UNSIGNED_INT ? sizeof(uint32_t) : sizeof(uint16_t);
+    for (const IndexRun &run : m_drawRuns) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, run.count, m_indexType,
+                                 reinterpret_cast<void *>(m_indexRange.offset + run.first * indexSize), m_baseVertex);
+    }
+}
+
+// Draws the CDLOD terrain instead of the uploaded mesh. It reaches far beyond the mesh's 10 units,
+// so the far plane follows its extent.
+void GLWidget::paintLod()
+{
+    m_lod.configure(ChunkBuilder::kTerrainSize * float(1 << settings.lodExtent), settings.octaves);
+    float farPlane = std::max(100.f, 2 * m_lod.quadtree().rootSize());
+    glm::mat4 proj = glm::perspective(45.0f, GLfloat(width()) / height(), 0.01f, farPlane);
+    m_lod.render(proj, m_camera * m_world, int(height() * devicePixelRatioF()), settings.showWireframeNormals);
+}
+
+// Modes whose camera orbits the planet, with the mouse wheel setting its altitude
+static bool isPlanetMode(int renderMode)
+{
+    return renderMode == RENDER_PLANET || renderMode == RENDER_TESSELLATED_PLANET;
+}
+
+// The view of a planet whose surface lies between `minRadius` and `maxRadius`, orbited by the same drag
+// controls, and its projection in `proj`. The view is built in double precision, as the mouse wheel
+// brings the camera down to metre-scale heights (on an Earth-sized planet) where a float camera position
+// would no longer resolve the quads below it.
+glm::dmat4 GLWidget::planetView(double minRadius, double maxRadius, glm::mat4 &proj) const
 {
-    // Create the OpenGLShape and get its vertices and normals
+    double distance = maxRadius + m_planetAltitude;
+    glm::dmat4 view = glm::translate(glm::dmat4(1.0), glm::dvec3(0, 0, -distance)) *
+                      glm::rotate(glm::dmat4(1.0), double(m_angleXY[1]), glm::dvec3(0, 1, 0)) *
+                      glm::rotate(glm::dmat4(1.0), double(m_angleXY[0]), glm::dvec3(1, 0, 0));
+
+    // Near enough for the ground below, far enough for the horizon beyond the highest peaks
+    double farPlane = std::sqrt(distance * distance - minRadius * minRadius) +
+                      std::sqrt(maxRadius * maxRadius - minRadius * minRadius);
+    proj = glm::perspective(45.0f, GLfloat(width()) / height(), float(m_planetAltitude / 10), float(farPlane));
+    return view;
+}
 
-        verts = m_terrain->generateShape();
-//    verts = m_terrain.generateTerrain();
+// Draws a unit-radius planet
+void GLWidget::paintPlanet()
+{
+    m_planet.configure(1.0, 0.02);
+    glm::mat4 proj;
+    glm::dmat4 view = planetView(m_planet.quadtree().minRadius(), m_planet.quadtree().maxRadius(), proj);
+    m_planet.render(proj, view, int(height() * devicePixelRatioF()), settings.showWireframeNormals);
+}
 
+// Draws the terrain from its heightfield texture; nothing in the mesh rings is read
+void GLWidget::paintHeightmap()
+{
+    m_heightmap.render(m_proj, m_camera * m_world, settings.showWireframeNormals);
+}
 
-    m_numTriangles = int(verts.size()) / 6;
+// Draws the terrain or the same planet as paintPlanet() from coarse patches, tessellated on the GPU
+void GLWidget::paintTessellated()
+{
+    int viewportHeight = int(height() * devicePixelRatioF());
+    if (settings.renderMode == RENDER_TESSELLATED_PLANET) {
+        m_tessellation.configurePlanet(1.0, 0.02);
+        glm::mat4 proj;
+        glm::dmat4 view = planetView(m_tessellation.planet().minRadius(), m_tessellation.planet().maxRadius(), proj);
+        m_tessellation.renderPlanet(proj, view, viewportHeight, settings.showWireframeNormals);
+    } else {
+        m_tessellation.renderTerrain(m_proj, m_camera * m_world, viewportHeight, settings.octaves,
+                                     settings.showWireframeNormals);
+    }
+}
 
-    m_vbo.bind();
-    m_vbo.allocate(verts.data(), verts.size()*sizeof(GLfloat));
+// Modes whose camera travels over the unbounded terrain, moved by the keyboard
+static bool isTravelMode(int renderMode)
+{
+    return renderMode == RENDER_CLIPMAP || renderMode == RENDER_STREAM;
+}
 
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-//    glEnableVertexAttribArray(2);
+// Draws the clipmap around m_groundCenter, the orbit's pivot
+void GLWidget::paintClipmap()
+{
+    m_clipmap.configure(settings.octaves);
+    float farPlane = float(2 * m_clipmap.reach());
+    glm::mat4 proj = glm::perspective(45.0f, GLfloat(width()) / height(), 0.01f, farPlane);
+    m_clipmap.render(proj, m_camera * m_world, m_groundCenter, settings.showWireframeNormals);
+}
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat),
-                             nullptr);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat),
-                             reinterpret_cast<void *>(3 * sizeof(GLfloat)));
-//    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(GLfloat),
-//                             reinterpret_cast<void *>(6 * sizeof(GLfloat)));
-    m_vbo.release();
+// Draws the chunks around m_groundCenter. Chunks still being sampled are missing for a frame or
+// a few; each one finished schedules a repaint.
+void GLWidget::paintStream()
+{
+    m_stream.configure(settings.octaves, settings.workerThreads, [this] {
+        QMetaObject::invokeMethod(this, [this] { update(); }, Qt::QueuedConnection);
+    });
+    float farPlane = float(2 * m_stream.reach());
+    glm::mat4 proj = glm::perspective(45.0f, GLfloat(width()) / height(), 0.01f, farPlane);
+    m_stream.render(proj, m_camera * m_world, m_groundCenter, settings.showWireframeNormals);
 }
 
 void GLWidget::paintGL()
 {
+    // Pick up the newest mesh the worker has finished, if any. The worker's reference is gone,
+    // so the CPU copy is freed as soon as it has been uploaded.
+    if (MeshPtr mesh = m_worker->takeMesh()) {
+        bindVbo(*mesh);
+    }
+    if (HeightfieldPtr heightfield = m_worker->takeHeightfield()) {
+        m_heightmap.upload(*heightfield);
+    }
+    if (m_programsCompact != m_compactVertices) {
+        destroyPrograms();
+        createPrograms(m_compactVertices);
+    }
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
 
+    if (settings.renderMode == RENDER_LOD) {
+        paintLod();
+        return;
+    }
+    if (settings.renderMode == RENDER_PLANET) {
+        paintPlanet();
+        return;
+    }
+    if (settings.renderMode == RENDER_HEIGHTMAP) {
+        paintHeightmap();
+        return;
+    }
+    if (settings.renderMode == RENDER_TESSELLATED_TERRAIN || settings.renderMode == RENDER_TESSELLATED_PLANET) {
+        paintTessellated();
+        return;
+    }
+    if (settings.renderMode == RENDER_CLIPMAP) {
+        paintClipmap();
+        return;
+    }
+    if (settings.renderMode == RENDER_STREAM) {
+        paintStream();
+        return;
+    }
+
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+    cullMesh();
 
     // Draw 3D shape
-    m_program->bind();
-    m_program->setUniformValue(m_default_projLoc, glmMatToQMat(m_proj));
-    m_program->setUniformValue(m_default_mvLoc, glmMatToQMat(m_camera * m_world));
-    QMatrix3x3 normalMatrix = glmMatToQMat(m_camera * m_world).normalMatrix();
+    bindProgram(m_program);
+    m_program->setUniformValue(m_default_projLoc, toQMatrix(m_proj));
+    m_program->setUniformValue(m_default_mvLoc, toQMatrix(m_camera * m_world));
+    QMatrix3x3 normalMatrix = toQMatrix(m_camera * m_world).normalMatrix();
     m_program->setUniformValue(m_default_normalLoc, normalMatrix);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDrawArrays(GL_TRIANGLES, 0, m_numTriangles);
+    drawMesh();
 
     if (settings.showWireframeNormals) {
         // Draw normals
-        m_normalsTipsProgram->bind(); // arrow head
-        m_normalsTipsProgram->setUniformValue(m_normalTip_projLoc, glmMatToQMat(m_proj));
-        m_normalsTipsProgram->setUniformValue(m_normalTip_mvLoc, glmMatToQMat(m_camera * m_world));
-        glDrawArrays(GL_TRIANGLES, 0, m_numTriangles);
-
-        m_normalsProgram->bind(); // arrow body
-        m_normalsProgram->setUniformValue(m_normal_projLoc, glmMatToQMat(m_proj));
-        m_normalsProgram->setUniformValue(m_normal_mvLoc, glmMatToQMat(m_camera * m_world));
+        bindProgram(m_normalsTipsProgram); // arrow head
+        m_normalsTipsProgram->setUniformValue(m_normalTip_projLoc, toQMatrix(m_proj));
+        m_normalsTipsProgram->setUniformValue(m_normalTip_mvLoc, toQMatrix(m_camera * m_world));
+        drawMesh();
+
+        bindProgram(m_normalsProgram); // arrow body
+        m_normalsProgram->setUniformValue(m_normal_projLoc, toQMatrix(m_proj));
+        m_normalsProgram->setUniformValue(m_normal_mvLoc, toQMatrix(m_camera * m_world));
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glDrawArrays(GL_TRIANGLES, 0, m_numTriangles);
+        drawMesh();
 
         // Draw wireframe
         glEnable(GL_POLYGON_OFFSET_LINE);
         glPolygonOffset(-1, -1);
-        m_wireframeProgram->bind();
-        m_wireframeProgram->setUniformValue(m_wireframe_projLoc, glmMatToQMat(m_proj));
-        m_wireframeProgram->setUniformValue(m_normal_mvLoc, glmMatToQMat(m_camera * m_world));
-        glDrawArrays(GL_TRIANGLES, 0, m_numTriangles);
+        bindProgram(m_wireframeProgram);
+        m_wireframeProgram->setUniformValue(m_wireframe_projLoc, toQMatrix(m_proj));
+        m_wireframeProgram->setUniformValue(m_normal_mvLoc, toQMatrix(m_camera * m_world));
+        drawMesh();
         glPolygonOffset(0, 0);
     }
 }
@@ -285,20 +531,15 @@ void GLWidget::initializeShapesAndParameters() {
     m_currShape = SHAPE_TRIANGLE;
     m_currParam1 = 1;
     m_currParam2 = 1;
-
-    m_terrain = new Terrain();
-    m_terrain->updateParams(m_currParam1);
-}
-
-QMatrix4x4 GLWidget::glmMatToQMat(glm::mat4x4 m) {
-    // Note: glm::mat4x4 is column-major order
-    //       QMatrix4x4 is row-major order
-
-    QMatrix4x4 qMat(m[0][0], m[1][0], m[2][0], m[3][0],
-                    m[0][1], m[1][1], m[2][1], m[3][1],
-                    m[0][2], m[1][2], m[2][2], m[3][2],
-                    m[0][3], m[1][3], m[2][3], m[3][3]);
-    return qMat;
+    m_currOctaves = settings.octaves;
+
+    // The worker calls back on its own thread, so only schedule a repaint from there
+    m_worker = new MeshWorker([this] {
+        QMetaObject::invokeMethod(this, [this] { update(); }, Qt::QueuedConnection);
+    });
+    Settings snapshot = settings;
+    snapshot.shapeParameter1 = m_currParam1;
+    m_worker->request(snapshot);
 }
 
 /* -----------------------------------------------
@@ -314,8 +555,10 @@ void GLWidget::mousePressEvent(QMouseEvent *event) {
 void GLWidget::mouseMoveEvent(QMouseEvent *event) {
     if (m_isDragging) {
         glm::vec2 currPos(event->position().y(), event->position().x());
-        m_angleXY.x += 10 * (currPos.x - m_oldXY.x) / (float) width();
-        m_angleXY.y += 10 * (currPos.y - m_oldXY.y) / (float) height();
+        // Close to the planet's surface a full-speed drag would skip whole continents
+        float speed = isPlanetMode(settings.renderMode) ? float(std::min(1.0, m_planetAltitude)) : 1.f;
+        m_angleXY.x += 10 * speed * (currPos.x - m_oldXY.x) / (float) width();
+        m_angleXY.y += 10 * speed * (currPos.y - m_oldXY.y) / (float) height();
         m_oldXY = currPos;
         if (m_angleXY[0] < -90) m_angleXY[0] = -90;
         if (m_angleXY[0] > 90) m_angleXY[0] = 90;
@@ -333,7 +576,11 @@ void GLWidget::mouseReleaseEvent(QMouseEvent *event) {
 void GLWidget::wheelEvent(QWheelEvent *event) {
     QPoint numPixels = event->pixelDelta();
     QPoint numDegrees = event->pixelDelta() / 8;
-    if (!numPixels.isNull()) {
+    if (isPlanetMode(settings.renderMode)) {
+        // Altitude zooms geometrically, from orbit down to the ground in a few hundred steps
+        double steps = !numPixels.isNull() ? numPixels.y() / 10.0 : numDegrees.y() / 15.0;
+        m_planetAltitude = std::clamp(m_planetAltitude * std::pow(0.9, steps), 1e-8, 10.0);
+    } else if (!numPixels.isNull()) {
         m_zoomZ *= powf(0.999f, -numPixels.y());
     } else {
         m_zoomZ *= powf(0.99f, -numDegrees.y() / 15);
@@ -341,6 +588,33 @@ void GLWidget::wheelEvent(QWheelEvent *event) {
     updateView();
 }
 
+// WASD moves the camera's pivot along the ground, relative to the view; Shift goes faster
+void GLWidget::keyPressEvent(QKeyEvent *event) {
+    if (!isTravelMode(settings.renderMode)) {
+        QOpenGLWidget::keyPressEvent(event);
+        return;
+    }
+    glm::vec2 move(0.f);
+    switch (event->key()) {
+    case Qt::Key_W: move.y = 1; break;
+    case Qt::Key_S: move.y = -1; break;
+    case Qt::Key_D: move.x = 1; break;
+    case Qt::Key_A: move.x = -1; break;
+    default:
+        QOpenGLWidget::keyPressEvent(event);
+        return;
+    }
+    // The view's right and forward directions, flattened onto the terrain
+    glm::mat4 toWorld = glm::inverse(m_camera * m_world);
+    glm::vec2 right = glm::vec2(toWorld * glm::vec4(1, 0, 0, 0));
+    glm::vec2 forward = glm::vec2(toWorld * glm::vec4(0, 1, -1, 0));
+    glm::vec2 step = move.x * right + move.y * forward;
+    if (glm::length(step) > 0) step = glm::normalize(step);
+    float speed = (event->modifiers() & Qt::ShiftModifier) ? 5.f : 0.5f;
+    m_groundCenter += glm::dvec2(step * speed);
+    update();
+}
+
 void GLWidget::updateView() {
     m_camera =
             glm::translate(glm::vec3(0.0, 0.0, -4.0 + m_zoomZ)) *
@@ -362,45 +636,42 @@ void GLWidget::settingsChange()
         return;
     }
 
-    // parameter settings
-    if (settings.shapeParameter1 != m_currParam1 || settings.shapeParameter2 != m_currParam2) {
+    // parameter settings: regenerate in the background from a snapshot, superseding any job in flight.
+    // The new mesh is uploaded by paintGL once it is ready, in the vertex format selected by then
+    // (the CPU copy is dropped after upload, so a format change needs a fresh mesh too).
+    bool heightmap = settings.renderMode == RENDER_HEIGHTMAP;
+    if (settings.shapeType != m_currShape || heightmap != m_currHeightmap ||
+        settings.shapeParameter1 != m_currParam1 || settings.shapeParameter2 != m_currParam2 ||
+        settings.octaves != m_currOctaves || settings.compactVertices != m_currCompactVertices) {
+        m_currShape = settings.shapeType;
+        m_currHeightmap = heightmap;
         m_currParam1 = settings.shapeParameter1;
         m_currParam2 = settings.shapeParameter2;
+        m_currOctaves = settings.octaves;
+        m_currCompactVertices = settings.compactVertices;
 
-            m_terrain->updateParams(settings.shapeParameter1);
+        m_worker->request(settings);
     }
 
-    bindVbo();
     update();
 }
 
 GLWidget::~GLWidget()
 {
-    delete m_terrain;
+    delete m_worker;
 
     if (m_program == nullptr) {
         return;
-    } else {
-        makeCurrent();
-        m_vbo.destroy();
-        delete m_program;
-        m_program = nullptr;
-        doneCurrent();
-    }
-    if (m_normalsProgram == nullptr) {
-        return;
-    } else {
-        makeCurrent();
-        delete m_normalsProgram;
-        m_normalsProgram = nullptr;
-        doneCurrent();
-    }
-    if (m_wireframeProgram == nullptr) {
-        return;
-    } else {
-        makeCurrent();
-        delete m_wireframeProgram;
-        m_wireframeProgram = nullptr;
-        doneCurrent();
     }
+    makeCurrent();
+    m_vertexRing.destroy();
+    m_indexRing.destroy();
+    m_lod.destroy();
+    m_planet.destroy();
+    m_heightmap.destroy();
+    m_tessellation.destroy();
+    m_clipmap.destroy();
+    m_stream.destroy();
+    destroyPrograms();
+    doneCurrent();
 }
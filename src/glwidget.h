@@ -5,12 +5,21 @@
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions_4_1_Core>
 #include <QOpenGLVertexArrayObject>
-#include <QOpenGLBuffer>
+#include <QKeyEvent>
 #include <QMatrix4x4>
 #include <QMouseEvent>
 #include <QWheelEvent>
 
+#include "clipmaprenderer.h"
+#include "heightmaprenderer.h"
+#include "lodrenderer.h"
+#include "meshworker.h"
+#include "planetrenderer.h"
+#include "shapes/CompactVertices.h"
 #include "shapes/Terrain.h"
+#include "streambuffer.h"
+#include "streamrenderer.h"
+#include "tessellationrenderer.h"
 #include "terraingenerator.h"
 
 QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
@@ -22,13 +31,27 @@ public:
     ~GLWidget();
 
     void settingsChange();
+    // The streamed terrain's chunk source, for its counters; null until the stream mode has drawn
+    const ChunkStreamer *streamer() const { return m_stream.streamer(); }
 
 protected:
     void initializeGL() override;
     void paintGL() override;
     void resizeGL(int width, int height) override;
-    QMatrix4x4 glmMatToQMat(glm::mat4x4 m);
-    void bindVbo();
+    void bindVbo(const Mesh &mesh);
+    void setVertexFormat(bool compact);
+    void drawMesh();
+    void cullMesh();
+    void createPrograms(bool compactVertices);
+    void destroyPrograms();
+    void bindProgram(QOpenGLShaderProgram *program);
+    void paintLod();
+    void paintPlanet();
+    void paintHeightmap();
+    void paintTessellated();
+    void paintClipmap();
+    void paintStream();
+    glm::dmat4 planetView(double minRadius, double maxRadius, glm::mat4 &proj) const;
 
     // Orbital Camera and Mouse Events stuff
     float m_zoomZ = 1.0;
@@ -40,13 +63,17 @@ protected:
     virtual void mouseMoveEvent(QMouseEvent *event) override;
     virtual void mouseReleaseEvent(QMouseEvent *event) override;
     virtual void wheelEvent(QWheelEvent *event) override;
+    virtual void keyPressEvent(QKeyEvent *event) override;
 
 private:
 //    TerrainGenerator m_terrain;
 
-    // VAO/VBO
+    // VAO and the streamed vertex / index buffers, allocated once; each mesh lives in one range of each
     QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer m_vbo;
+    StreamBuffer m_vertexRing;
+    StreamBuffer m_indexRing;
+    StreamBuffer::Range m_vertexRange;
+    StreamBuffer::Range m_indexRange;
 
     // Shape shader program stuff
     QOpenGLShaderProgram *m_program = nullptr;
@@ -68,21 +95,54 @@ private:
     int m_wireframe_projLoc;
     int m_wireframe_mvLoc;
 
-    // Vertices, matrices, etc.
-    std::vector<GLfloat> verts;
-    int m_numTriangles;
+    // Indices, matrices, etc.
+    int m_numIndices = 0;
+    GLenum m_indexType = GL_UNSIGNED_SHORT;
+    GLint m_baseVertex = 0; // m_vertexRange's first vertex
+    bool m_compactVertices = false; // layout of the mesh in the rings, and of the VAO's attributes
+    bool m_programsCompact = false; // layout the shader programs were built for
+    CompactBounds m_compactBounds;
+    // The mesh's chunks, and the runs of its indices left after culling them this frame
+    struct IndexRun
+    {
+        int first;
+        int count;
+    };
+    MeshChunks m_meshChunks;
+    std::vector<uint8_t> m_chunkVisible;
+    std::vector<IndexRun> m_drawRuns;
     glm::mat4x4 m_proj   = glm::mat4(1.0f);
     glm::mat4x4 m_camera = glm::mat4(1.0f);
     glm::mat4x4 m_world  = glm::mat4(1.0f);
     static bool m_transparent;
 
+    // Draws the terrain as CDLOD chunks in RENDER_LOD mode
+    LodRenderer m_lod;
+    // Draws the planet in RENDER_PLANET mode, from this height above its highest peak (in radii)
+    PlanetRenderer m_planet;
+    double m_planetAltitude = 1.0;
+    // Draws the terrain's heightfield on the GPU in RENDER_HEIGHTMAP mode
+    HeightmapRenderer m_heightmap;
+    // Draws the terrain or the planet through the tessellation stages in the RENDER_TESSELLATED_* modes
+    TessellationRenderer m_tessellation;
+    // Draws the unbounded terrain as a geometry clipmap in RENDER_CLIPMAP mode
+    ClipmapRenderer m_clipmap;
+    // Draws it as streamed chunks in RENDER_STREAM mode
+    StreamRenderer m_stream;
+    // Point on the unbounded terrain the camera orbits in those two modes; the keyboard moves it
+    glm::dvec2 m_groundCenter = glm::dvec2(0.0);
+
     // Tracking shape to render
     int m_currShape;
 
-    Terrain* m_terrain;
+    // Generates meshes off the GUI thread; paintGL uploads whatever it has finished
+    MeshWorker* m_worker = nullptr;
 
     // Tracking params
     int m_currParam1;
     int m_currParam2;
+    int m_currOctaves;
+    bool m_currCompactVertices = false;
+    bool m_currHeightmap = false; // whether the worker was last asked for a heightfield rather than a mesh
     bool m_currShowWireframeNormals = true;
 };
@@ -0,0 +1,166 @@
+#include "heightmaprenderer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QOpenGLShaderProgram>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+
+#include "vertexattributes.h"
+
+static const char *heightmapVertexShaderSource =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 gridPos;\n"
+    "out vec3 vert;\n"
+    "out vec3 vertNormal;\n"
+    "uniform sampler2D heights;\n"   // unscaled, one texel per heightfield sample
+    "uniform float tiles;\n"         // grid quads per side drawn
+    "uniform vec2 origin;\n"         // the terrain covers [origin, origin + size] on both axes
+    "uniform float size;\n"
+    "uniform float heightScale;\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform mat4 mvMatrix;\n"
+    "uniform mat3 normalMatrix;\n"
+    "float heightAt(vec2 uv) { return textureLod(heights, uv, 0.0).r; }\n"
+    "void main() {\n"
+    "   vec2 t = gridPos / tiles;\n"
+    "   vec2 texels = vec2(textureSize(heights, 0));\n"
+    "   vec2 uv = (t * (texels - 1.0) + 0.5) / texels;\n" // texel centers, so grid vertices hit samples
+    "   float h = heightAt(uv);\n"
+    // Central differences one texel either way, one-sided along the border
+    "   vec2 lo = 0.5 / texels, hi = 1.0 - lo, texel = 1.0 / texels;\n"
+    "   float xl = max(uv.x - texel.x, lo.x), xh = min(uv.x + texel.x, hi.x);\n"
+    "   float yl = max(uv.y - texel.y, lo.y), yh = min(uv.y + texel.y, hi.y);\n"
+    "   float spacing = size / (texels.x - 1.0);\n"
+    "   float dx = (heightAt(vec2(xh, uv.y)) - heightAt(vec2(xl, uv.y))) / ((xh - xl) * texels.x * spacing);\n"
+    "   float dy = (heightAt(vec2(uv.x, yh)) - heightAt(vec2(uv.x, yl))) / ((yh - yl) * texels.y * spacing);\n"
+    "   vec3 normal = normalize(vec3(-heightScale * dx, -heightScale * dy, 1.0));\n"
+    "   vec4 position = vec4(origin + t * size, heightScale * h, 1.0);\n"
+    "   vert = vec3(mvMatrix * position);\n"
+    "   vertNormal = normalMatrix * normal;\n"
+    "   gl_Position = projMatrix * mvMatrix * position;\n"
+    "}\n";
+
+void HeightmapRenderer::create()
+{
+    initializeOpenGLFunctions();
+
+    m_program = new QOpenGLShaderProgram;
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, heightmapVertexShaderSource);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, glslSource({shadeSource, pointLitFragmentSource}).c_str());
+    m_program->link();
+    m_program->bind();
+    m_program->setUniformValue("heights", 0);
+    m_program->setUniformValue("lightPos", QVector3D(70, 70, 70));
+    m_program->release();
+
+    int side = kMaxTiles + 1;
+    std::vector<unsigned char> vertices(size_t(side) * side * GridVertexFormat::stride);
+    MeshWriter<GridVertexFormat> writer(vertices.data(), side * side);
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) writer.write(y * side + x, glm::u16vec2(x, y));
+    }
+
+    // Shell s holds the quads with max(x, y) == s: column s bottom to top, then row s left to right.
+    // Each quad is split along the same diagonal as Terrain's.
+    std::vector<uint32_t> indices;
+    indices.reserve(size_t(kMaxTiles) * kMaxTiles * 6);
+    auto quad = [&](int x, int y) {
+        uint32_t bottomLeft = uint32_t(y * side + x), bottomRight = bottomLeft + 1;
+        uint32_t topLeft = bottomLeft + side, topRight = topLeft + 1;
+        indices.insert(indices.end(), {topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight});
+    };
+    for (int shell = 0; shell < kMaxTiles; shell++) {
+        for (int y = 0; y <= shell; y++) quad(shell, y);
+        for (int x = 0; x < shell; x++) quad(x, shell);
+    }
+
+    m_vao.create();
+    m_vao.bind();
+    glGenBuffers(1, &m_vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertices.size()), vertices.data(), GL_STATIC_DRAW);
+    setVertexAttributes<GridVertexFormat>(this);
+    glGenBuffers(1, &m_indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indices.size() * sizeof(uint32_t)), indices.data(), GL_STATIC_DRAW);
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_samples = 0;
+}
+
+void HeightmapRenderer::destroy()
+{
+    delete m_program;
+    m_program = nullptr;
+    glDeleteBuffers(1, &m_vertexBuffer);
+    glDeleteBuffers(1, &m_indexBuffer);
+    glDeleteTextures(1, &m_texture);
+    m_vertexBuffer = m_indexBuffer = m_texture = 0;
+    m_vao.destroy();
+    m_samples = 0;
+}
+
+void HeightmapRenderer::upload(const Heightfield &heightfield)
+{
+    int samples = heightfield.samplesPerSide();
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (samples != m_samples) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, samples, samples, 0, GL_RED, GL_FLOAT, heightfield.heights().data());
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, samples, samples, GL_RED, GL_FLOAT, heightfield.heights().data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_samples = samples;
+    m_origin = heightfield.origin();
+    m_size = heightfield.size();
+    m_heightScale = heightfield.heightScale();
+}
+
+void HeightmapRenderer::render(const glm::mat4 &proj, const glm::mat4 &modelView, bool wireframe)
+{
+    if (!hasHeightfield()) return;
+    int tiles = std::min(m_samples - 1, kMaxTiles);
+
+    m_vao.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    m_program->bind();
+    m_program->setUniformValue("tiles", float(tiles));
+    m_program->setUniformValue("origin", QVector2D(m_origin, m_origin));
+    m_program->setUniformValue("size", m_size);
+    m_program->setUniformValue("heightScale", m_heightScale);
+    m_program->setUniformValue("projMatrix", toQMatrix(proj));
+    m_program->setUniformValue("mvMatrix", toQMatrix(modelView));
+    m_program->setUniformValue("normalMatrix", toQMatrix(modelView).normalMatrix());
+
+    GLsizei count = GLsizei(tiles) * tiles * 6;
+    int passes = wireframe ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        bool lines = pass == 1;
+        m_program->setUniformValue("wireframe", lines);
+        glPolygonMode(GL_FRONT_AND_BACK, lines ? GL_LINE : GL_FILL);
+        if (lines) {
+            glEnable(GL_POLYGON_OFFSET_LINE);
+            glPolygonOffset(-1, -1);
+        }
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+    }
+    glDisable(GL_POLYGON_OFFSET_LINE);
+    glPolygonOffset(0, 0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    m_program->release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_vao.release();
+}
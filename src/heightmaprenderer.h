@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLVertexArrayObject>
+
+#include "shapes/Heightfield.h"
+#include "shapes/VertexFormat.h"
+
+QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
+
+// Grid vertex (column, row), the only vertex data the heightmap renderer uploads
+using GridVertexFormat = VertexFormat<Attribute<uint16_t, 2>>;
+
+// Draws the terrain by displacing one shared flat grid on the GPU instead of uploading a mesh.
+//
+// The heightfield goes up as an R32F texture, one texel per sample; the vertex shader reads each
+// vertex's height from it and rebuilds the normal from the neighbouring texels. The grid is built
+// once, kMaxTiles quads per side, with its quads ordered in shells of increasing max(column, row):
+// the first T^2 quads are then exactly a T x T grid, so one draw call covers every terrain resolution
+// up to kMaxTiles, vertex for sample. Finer heightfields are drawn on the whole grid, filtered.
+// Needs a current GL context throughout.
+class HeightmapRenderer : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    static constexpr int kMaxTiles = 256;
+
+    void create();
+    void destroy();
+
+    // Replaces the heights with `heightfield`'s, reallocating the texture only when its size changes
+    void upload(const Heightfield &heightfield);
+    bool hasHeightfield() const { return m_samples > 0; }
+
+    // `modelView` maps terrain coordinates (z up) to the eye
+    void render(const glm::mat4 &proj, const glm::mat4 &modelView, bool wireframe);
+
+private:
+    QOpenGLShaderProgram *m_program = nullptr;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_vertexBuffer = 0;
+    GLuint m_indexBuffer = 0;
+    GLuint m_texture = 0;
+
+    int m_samples = 0; // texels per side
+    float m_origin = 0.f;
+    float m_size = 1.f;
+    float m_heightScale = 1.f;
+};
@@ -0,0 +1,60 @@
+#include "ChunkBuilder.h"
+
+#include <cmath>
+
+#include "shapes/CompactVertices.h"
+
+void ChunkBuilder::setSeed(uint32_t seed) {
+    m_perlin.setTable(GradientTable::forSeed(seed));
+}
+
+float ChunkBuilder::noiseCoordinate(double world) {
+    double period = kPeriod / kTerrainSize;
+    double u = (world + kTerrainSize / 2) / kTerrainSize;
+    return float(u - period * std::floor(u / period + 0.5));
+}
+
+float ChunkBuilder::heightBound() const {
+    return kHeightScale * fbmBound<DefaultFbm>(m_perlin.octaves());
+}
+
+void ChunkBuilder::build(const LodQuadtree &tree, int level, int x, int y, void *out) {
+    build(glm::dvec2(tree.nodeOrigin(level, x, y)), tree.quadSize(level), tree.gridSize(), out);
+}
+
+void ChunkBuilder::build(const glm::dvec2 &origin, double quad, int grid, void *out) {
+    int side = grid + 1;
+    int count = vertexCount(grid);
+
+    m_x.resize(count);
+    m_y.resize(count);
+    m_heights.resize(count);
+    m_dx.resize(count);
+    m_dy.resize(count);
+    for (int j = 0; j < side; j++) {
+        for (int i = 0; i < side; i++) {
+            m_x[j * side + i] = noiseCoordinate(origin.x + i * quad);
+            m_y[j * side + i] = noiseCoordinate(origin.y + j * quad);
+        }
+    }
+    m_perlin.getHeightAndGradient(m_x.data(), m_y.data(), m_heights.data(), m_dx.data(), m_dy.data(), count);
+
+    // Slopes are per normalized unit, as in Heightfield::normal()
+    float toWorld = kHeightScale / kTerrainSize;
+    auto normal = [&](int k) {
+        return encodeOctNormal(glm::normalize(glm::vec3(-m_dx[k] * toWorld, -m_dy[k] * toWorld, 1.f)));
+    };
+
+    MeshWriter<ChunkVertexFormat> writer(out, count);
+    for (int j = 0; j < side; j++) {
+        for (int i = 0; i < side; i++) {
+            int k = j * side + i;
+            // Odd rows and columns collapse onto their even neighbour below, as in the coarser grid
+            int coarse = (j & ~1) * side + (i & ~1);
+            glm::i8vec2 n = normal(k), coarseNormal = normal(coarse);
+            writer.write(k, glm::u16vec2(i, j),
+                         glm::vec2(kHeightScale * m_heights[k], kHeightScale * m_heights[coarse]),
+                         glm::i8vec4(n.x, n.y, coarseNormal.x, coarseNormal.y));
+        }
+    }
+}
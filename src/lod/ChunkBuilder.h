@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "lod/LodQuadtree.h"
+#include "noise/PerlinBatch.h"
+#include "shapes/VertexFormat.h"
+
+// One vertex of a CDLOD chunk, 16 bytes:
+//   0: grid position (i, j) within the node, 0..gridSize
+//   1: height here, and at the vertex this one collapses onto in the next coarser level
+//   2: octahedral normals, here (xy) and at that same coarser vertex (zw)
+// World x and y come from the node's origin and quad size, which the shader gets as uniforms.
+using ChunkVertexFormat = VertexFormat<Attribute<uint16_t, 2>, Attribute<float, 2>, Attribute<int8_t, 4, true>>;
+
+// Samples the viewer's terrain function over LodQuadtree nodes.
+//
+// The heights are Terrain's: noise at (world + 5) / 10, scaled by 10, but over the whole plane, so
+// the original 10 x 10 terrain is the patch around the origin. The plane repeats every kPeriod units
+// along both axes: the gradient lattice wraps every GradientTable::kSize cells of the first octave,
+// and every finer octave's frequency is a whole multiple of that one. Every sample is taken from its
+// world position alone, so nodes sharing an edge write identical vertices along it.
+class ChunkBuilder
+{
+public:
+    static constexpr float kTerrainSize = 10.f;
+    static constexpr float kHeightScale = 10.f;
+    static constexpr double kPeriod = double(kTerrainSize) * GradientTable::kSize / DefaultFbm::baseFrequency;
+
+    // The noise coordinate of world coordinate `world`, wrapped in double to the period around the
+    // origin, so the float the noise takes is as precise anywhere as it is near the origin
+    static float noiseCoordinate(double world);
+
+    void setOctaves(int octaves) { m_perlin.setOctaves(octaves); }
+    int octaves() const { return m_perlin.octaves(); }
+    void setSeed(uint32_t seed);
+
+    // No height ever exceeds this in magnitude, for the quadtree's bounding boxes
+    float heightBound() const;
+
+    static int vertexCount(int gridSize) { return (gridSize + 1) * (gridSize + 1); }
+
+    // Writes the node's vertexCount(tree.gridSize()) vertices, row by row, to `out`
+    void build(const LodQuadtree &tree, int level, int x, int y, void *out);
+    // Likewise for any grid of `gridSize` x `gridSize` quads of `quadSize`, from `origin`
+    void build(const glm::dvec2 &origin, double quadSize, int gridSize, void *out);
+
+private:
+    PerlinBatch m_perlin;
+    std::vector<float> m_x, m_y, m_heights, m_dx, m_dy;
+};
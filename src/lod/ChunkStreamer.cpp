@@ -0,0 +1,128 @@
+#include "ChunkStreamer.h"
+
+#include <algorithm>
+
+#include "lod/ChunkBuilder.h"
+#include "util/Parallel.h"
+
+ChunkStreamer::ChunkStreamer(int gridSize, double quadSize, size_t capacity, int threads,
+                             std::function<void()> chunkReady)
+    : m_gridSize(gridSize), m_quadSize(quadSize), m_capacity(capacity), m_chunkReady(std::move(chunkReady)) {
+    int count = resolveThreadCount(threads);
+    for (int t = 0; t < count; t++) m_threads.emplace_back(&ChunkStreamer::run, this);
+}
+
+ChunkStreamer::~ChunkStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &thread : m_threads) thread.join();
+}
+
+void ChunkStreamer::setOctaves(int octaves) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_octaves = octaves;
+    m_generation++;
+    m_cache.clear();
+    m_recent.clear();
+    m_pending.clear();
+    m_queue.clear();
+}
+
+void ChunkStreamer::beginFrame() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (!it->second.inFlight && it->second.frame < m_frame) {
+            it = m_pending.erase(it);
+            m_counters.dropped++;
+        } else {
+            ++it;
+        }
+    }
+    // The rest were asked for last frame; they stay pending, and this frame's requests queue them again
+    m_queue.clear();
+    m_frame++;
+}
+
+ChunkDataPtr ChunkStreamer::request(int x, int y) {
+    uint64_t k = key(x, y);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto cached = m_cache.find(k);
+        if (cached != m_cache.end()) {
+            m_recent.splice(m_recent.begin(), m_recent, cached->second.use);
+            m_counters.hits++;
+            return cached->second.data;
+        }
+        auto [it, added] = m_pending.try_emplace(k);
+        Pending &pending = it->second;
+        if (added) {
+            pending.requested = Clock::now();
+            m_counters.misses++;
+        }
+        if (pending.inFlight || pending.frame == m_frame) return nullptr;
+        pending.frame = m_frame;
+        m_queue.push_back(k);
+    }
+    m_wake.notify_one();
+    return nullptr;
+}
+
+ChunkStreamer::Counters ChunkStreamer::counters() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Counters counters = m_counters;
+    counters.cached = int(m_cache.size());
+    counters.queued = int(m_queue.size());
+    return counters;
+}
+
+void ChunkStreamer::run() {
+    // Each worker samples with its own builder and scratch buffers
+    ChunkBuilder builder;
+    size_t bytes = size_t(ChunkBuilder::vertexCount(m_gridSize)) * ChunkVertexFormat::stride;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+        if (m_quit) return;
+
+        uint64_t k = m_queue.front();
+        m_queue.pop_front();
+        auto pending = m_pending.find(k);
+        if (pending == m_pending.end() || pending->second.inFlight) continue;
+        pending->second.inFlight = true;
+        uint64_t generation = m_generation;
+        if (builder.octaves() != m_octaves) builder.setOctaves(m_octaves);
+        lock.unlock();
+
+        Clock::time_point start = Clock::now();
+        auto data = std::make_shared<ChunkData>(bytes);
+        int x = int(int32_t(uint32_t(k >> 32))), y = int(int32_t(uint32_t(k)));
+        builder.build(glm::dvec2(x, y) * chunkSize(), m_quadSize, m_gridSize, data->data());
+        Clock::time_point end = Clock::now();
+
+        lock.lock();
+        if (generation != m_generation) continue; // setOctaves() has dropped its entry
+
+        pending = m_pending.find(k);
+        double latency = std::chrono::duration<double>(end - pending->second.requested).count();
+        m_pending.erase(pending);
+        m_recent.push_front(k);
+        m_cache[k] = Entry{std::move(data), m_recent.begin()};
+        while (m_cache.size() > m_capacity) {
+            m_cache.erase(m_recent.back());
+            m_recent.pop_back();
+            m_counters.evicted++;
+        }
+        m_counters.generated++;
+        m_counters.buildSeconds += std::chrono::duration<double>(end - start).count();
+        m_counters.latencySeconds += latency;
+        m_counters.maxLatencySeconds = std::max(m_counters.maxLatencySeconds, latency);
+
+        lock.unlock();
+        m_chunkReady();
+        lock.lock();
+    }
+}
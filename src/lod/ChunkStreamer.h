@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Vertices of one streamed chunk, in ChunkVertexFormat
+using ChunkData = std::vector<unsigned char>;
+using ChunkDataPtr = std::shared_ptr<const ChunkData>;
+
+// Streams ChunkBuilder's unbounded terrain as a grid of equal square chunks, sampled on worker threads.
+//
+// A chunk is requested by its column and row. If it is not cached it is queued, and a later request
+// finds it once a worker has sampled it. Each frame's requests are served in the order they were made,
+// so asking for the nearest chunks first gets them first, and queued chunks that a whole frame did not
+// ask for again are dropped before any work is done on them. The cache keeps at most `capacity`
+// chunks, dropping the least recently requested one to make room, so memory stays bounded however far
+// the camera travels.
+class ChunkStreamer
+{
+public:
+    struct Counters
+    {
+        uint64_t hits = 0;          // requests served from the cache
+        uint64_t misses = 0;        // chunks queued for sampling; frames asking again meanwhile do not count
+        uint64_t generated = 0;
+        uint64_t evicted = 0;
+        uint64_t dropped = 0;       // queued chunks no longer requested by the time a worker was free
+        double buildSeconds = 0;    // summed over generated chunks: sampling time on the worker
+        double latencySeconds = 0;  // summed over generated chunks: from first request to cached
+        double maxLatencySeconds = 0;
+        int cached = 0;
+        int queued = 0;
+
+        double hitRate() const { return hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0; }
+        double meanBuildMs() const { return generated > 0 ? 1e3 * buildSeconds / double(generated) : 0.0; }
+        double meanLatencyMs() const { return generated > 0 ? 1e3 * latencySeconds / double(generated) : 0.0; }
+    };
+
+    // Chunks of `gridSize` x `gridSize` quads of `quadSize`, sampled by `threads` workers (0 means one
+    // per hardware thread). `chunkReady` is called on a worker thread whenever a chunk has been cached.
+    ChunkStreamer(int gridSize, double quadSize, size_t capacity, int threads, std::function<void()> chunkReady);
+    ~ChunkStreamer();
+
+    // Drops every cached and queued chunk; those in flight are discarded when they finish
+    void setOctaves(int octaves);
+    int octaves() const { return m_octaves; }
+
+    int gridSize() const { return m_gridSize; }
+    double chunkSize() const { return m_gridSize * m_quadSize; }
+    size_t capacity() const { return m_capacity; }
+    int threadCount() const { return int(m_threads.size()); }
+    // World position of chunk (x, y)'s low corner
+    glm::dvec2 chunkOrigin(int x, int y) const { return glm::dvec2(x, y) * chunkSize(); }
+
+    // Starts a frame's requests: drops the queued chunks the last frame did not ask for
+    void beginFrame();
+    // Chunk (x, y)'s vertices, or null if they are not sampled yet; it is then queued
+    ChunkDataPtr request(int x, int y);
+
+    Counters counters() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        ChunkDataPtr data;
+        std::list<uint64_t>::iterator use; // position in m_recent
+    };
+    struct Pending
+    {
+        Clock::time_point requested; // first request
+        uint64_t frame = 0;          // last frame that queued it
+        bool inFlight = false;
+    };
+
+    static uint64_t key(int x, int y) { return uint64_t(uint32_t(x)) << 32 | uint32_t(y); }
+    void run();
+
+    const int m_gridSize;
+    const double m_quadSize;
+    const size_t m_capacity;
+    std::function<void()> m_chunkReady;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit = false;
+    int m_octaves = 4;
+    uint64_t m_generation = 0; // bumped by setOctaves(), so chunks in flight can tell they are stale
+    uint64_t m_frame = 1;
+    std::unordered_map<uint64_t, Entry> m_cache;
+    std::list<uint64_t> m_recent; // cached keys, most recently requested first
+    std::unordered_map<uint64_t, Pending> m_pending;
+    std::deque<uint64_t> m_queue; // this frame's requests not yet taken by a worker
+    Counters m_counters;
+
+    std::vector<std::thread> m_threads;
+};
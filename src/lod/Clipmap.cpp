@@ -0,0 +1,94 @@
+#include "Clipmap.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include "lod/ChunkBuilder.h"
+
+void Clipmap::configure(int levels, double spacing, int octaves) {
+    m_octaves = octaves;
+    m_terrain.setOctaves(octaves);
+    m_levels.assign(size_t(levels), Level());
+    for (int l = 0; l < levels; l++) {
+        m_levels[size_t(l)].spacing = spacing * std::exp2(l);
+        m_levels[size_t(l)].heights.assign(size_t(kSide) * kSide, 0.f);
+    }
+    m_stats = Stats();
+}
+
+float Clipmap::sample(const Level &level, int64_t i, int64_t j) {
+    m_stats.samples++;
+    // ChunkBuilder's mapping, so the 10 x 10 terrain is the patch around the origin
+    return ChunkBuilder::kHeightScale * m_terrain.getHeight(ChunkBuilder::noiseCoordinate(double(i) * level.spacing),
+                                                            ChunkBuilder::noiseCoordinate(double(j) * level.spacing));
+}
+
+// Lattice column i over the grid's rows
+void Clipmap::fillColumn(Level &level, int64_t i) {
+    int column = wrap(i);
+    for (int64_t j = level.y0; j < level.y0 + kSide; j++) {
+        level.heights[size_t(wrap(j)) * kSide + column] = sample(level, i, j);
+    }
+    if (!level.dirtyAll) level.dirtyColumns.push_back(column);
+}
+
+// Lattice row j over the grid's columns, except [skipBegin, skipEnd), which fillColumn() has just written
+void Clipmap::fillRow(Level &level, int64_t j, int64_t skipBegin, int64_t skipEnd) {
+    float *row = level.heights.data() + size_t(wrap(j)) * kSide;
+    for (int64_t i = level.x0; i < level.x0 + kSide; i++) {
+        if (i >= skipBegin && i < skipEnd) continue;
+        row[wrap(i)] = sample(level, i, j);
+    }
+    if (!level.dirtyAll) level.dirtyRows.push_back(wrap(j));
+}
+
+void Clipmap::update(const glm::dvec2 &center) {
+    m_stats = Stats();
+    for (Level &level : m_levels) {
+        // Origins on even lattice coordinates, so this grid's samples are every other one of the next
+        int64_t x0 = 2 * int64_t(std::floor(center.x / (2 * level.spacing))) - kGridSize / 2;
+        int64_t y0 = 2 * int64_t(std::floor(center.y / (2 * level.spacing))) - kGridSize / 2;
+        int64_t dx = x0 - level.x0, dy = y0 - level.y0;
+        if (level.valid && dx == 0 && dy == 0) continue;
+
+        if (!level.valid || std::llabs(dx) >= kSide || std::llabs(dy) >= kSide) {
+            level.x0 = x0;
+            level.y0 = y0;
+            level.dirtyAll = true;
+            level.dirtyRows.clear();
+            level.dirtyColumns.clear();
+            for (int64_t i = x0; i < x0 + kSide; i++) fillColumn(level, i);
+            level.valid = true;
+            m_stats.levelsRefilled++;
+            continue;
+        }
+
+        // Columns that came into the grid, over all of its new rows; then the new rows, over the rest
+        int64_t oldX0 = level.x0, oldY0 = level.y0;
+        level.x0 = x0;
+        level.y0 = y0;
+        int64_t columnsBegin = dx > 0 ? oldX0 + kSide : x0;
+        int64_t columnsEnd = dx > 0 ? x0 + kSide : oldX0;
+        for (int64_t i = columnsBegin; i < columnsEnd; i++) fillColumn(level, i);
+        int64_t rowsBegin = dy > 0 ? oldY0 + kSide : y0;
+        int64_t rowsEnd = dy > 0 ? y0 + kSide : oldY0;
+        for (int64_t j = rowsBegin; j < rowsEnd; j++) fillRow(level, j, columnsBegin, columnsEnd);
+    }
+}
+
+void Clipmap::clearDirty() {
+    for (Level &level : m_levels) {
+        level.dirtyRows.clear();
+        level.dirtyColumns.clear();
+        level.dirtyAll = false;
+    }
+}
+
+glm::ivec2 Clipmap::holeOffset(int level) const {
+    const Level &coarse = m_levels[size_t(level)], &fine = m_levels[size_t(level) - 1];
+    return glm::ivec2(int(fine.x0 / 2 - coarse.x0), int(fine.y0 / 2 - coarse.y0));
+}
+
+float Clipmap::height(int level, int64_t i, int64_t j) const {
+    return m_levels[size_t(level)].heights[size_t(wrap(j)) * kSide + wrap(i)];
+}
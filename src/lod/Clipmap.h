@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "shapes/Terrain.h"
+
+// Geometry clipmap over ChunkBuilder's unbounded terrain: nested square grids of heights centred on
+// the camera, each level at twice the sample spacing of the one inside it.
+//
+// Every level is a kGridSize x kGridSize quad grid whose (kGridSize + 1)^2 heights live in a toroidal
+// buffer: lattice sample (i, j) at that level's spacing is stored at (i mod kSide, j mod kSide), so
+// when the camera moves the samples still covered stay where they are and only the newly exposed
+// rows and columns are evaluated, through Terrain::getHeight(). A frame's cost follows how far the
+// camera moved, not how far the terrain reaches.
+//
+// Grid origins move in steps of two samples. A level's samples then coincide with every other sample
+// of the level inside it, and that finer grid covers the middle half of this one, kGridSize / 4 quads
+// (or one more) in from its low edges: holeOffset().
+class Clipmap
+{
+public:
+    static constexpr int kGridSize = 128; // a multiple of 4
+    static constexpr int kSide = kGridSize + 1;
+
+    struct Level
+    {
+        int64_t x0 = 0;       // lattice coordinates of the grid's low corner, in units of spacing
+        int64_t y0 = 0;
+        double spacing = 1.0;
+        std::vector<float> heights; // kSide^2 world heights, toroidally addressed
+        // Toroidal rows and columns written since the last clearDirty(), or all of them
+        std::vector<int> dirtyRows;
+        std::vector<int> dirtyColumns;
+        bool dirtyAll = false;
+        bool valid = false;
+    };
+
+    struct Stats
+    {
+        int samples = 0;         // heights evaluated by the last update()
+        int levelsRefilled = 0;  // levels that moved too far to keep any of their samples
+    };
+
+    // `levels` levels, the finest `spacing` apart, of `octaves` octaves of noise; drops every sample
+    void configure(int levels, double spacing, int octaves);
+    int levelCount() const { return int(m_levels.size()); }
+    int octaves() const { return m_octaves; }
+    double spacing(int level) const { return m_levels[size_t(level)].spacing; }
+
+    // Recentres every level on `center` (world x and y), evaluating only the samples newly covered
+    void update(const glm::dvec2 &center);
+    const Stats &stats() const { return m_stats; }
+
+    const Level &level(int level) const { return m_levels[size_t(level)]; }
+    void clearDirty();
+
+    // Quads from `level`'s low corner to the low corner of the level inside it, on each axis
+    glm::ivec2 holeOffset(int level) const;
+    // Stored height of lattice sample (i, j) of `level`, which must be inside its grid
+    float height(int level, int64_t i, int64_t j) const;
+
+    static int wrap(int64_t i) { return int(((i % kSide) + kSide) % kSide); }
+
+private:
+    float sample(const Level &level, int64_t i, int64_t j);
+    void fillColumn(Level &level, int64_t i);
+    void fillRow(Level &level, int64_t j, int64_t skipBegin, int64_t skipEnd);
+
+    Terrain m_terrain;
+    int m_octaves = 4;
+    std::vector<Level> m_levels;
+    Stats m_stats;
+};
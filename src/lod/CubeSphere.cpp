@@ -0,0 +1,26 @@
+#include "CubeSphere.h"
+
+#include <cmath>
+
+// Outward axis, u axis and v axis of each face
+static const glm::dvec3 kFaceAxes[kCubeFaces][3] = {
+    {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}},
+    {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+    {{0, 1, 0}, {0, 0, 1}, {1, 0, 0}},
+    {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+    {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+    {{0, 0, -1}, {0, 1, 0}, {1, 0, 0}},
+};
+
+glm::dvec3 cubeFacePoint(int face, double u, double v) {
+    const glm::dvec3 *axes = kFaceAxes[face];
+    return axes[0] + u * axes[1] + v * axes[2];
+}
+
+glm::dvec3 cubeToSphere(const glm::dvec3 &c) {
+    // Each component only depends on the squares of the others, so it is symmetric between faces
+    glm::dvec3 s = c * c;
+    return {c.x * std::sqrt(1 - s.y / 2 - s.z / 2 + s.y * s.z / 3),
+            c.y * std::sqrt(1 - s.z / 2 - s.x / 2 + s.z * s.x / 3),
+            c.z * std::sqrt(1 - s.x / 2 - s.y / 2 + s.x * s.y / 3)};
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// The unit sphere as the six faces of a cube, each face a [-1, 1]^2 (u, v) square.
+//
+// Faces are numbered +X, -X, +Y, -Y, +Z, -Z. Each face's u and v axes are chosen so that u x v
+// points out of the cube: counter-clockwise in (u, v) is counter-clockwise seen from outside.
+// Points on an edge shared by two faces come out bit-identical from both, as long as their
+// u and v are exact (dyadic) values.
+constexpr int kCubeFaces = 6;
+
+// Point on the cube's surface
+glm::dvec3 cubeFacePoint(int face, double u, double v);
+
+// Unit direction for a cube point. Uses the "spherified cube" mapping rather than plain
+// normalization, which keeps quads within a factor of ~1.4 of each other in area over a face.
+glm::dvec3 cubeToSphere(const glm::dvec3 &cube);
+
+inline glm::dvec3 cubeSphereDirection(int face, double u, double v) {
+    return cubeToSphere(cubeFacePoint(face, u, v));
+}
@@ -0,0 +1,114 @@
+#include "LodQuadtree.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Fraction of a level's own distance band after which it starts morphing into the next level
+static constexpr float kMorphStartRatio = 0.66f;
+// Stands in for "never" as the coarsest level's morph distances
+static constexpr float kNoMorph = 1e30f;
+
+void LodQuadtree::configure(float extent, float finestQuadSize, int gridSize, float minHeight, float maxHeight) {
+    m_finestQuadSize = std::exp2(std::floor(std::log2(finestQuadSize)));
+    m_gridSize = gridSize;
+    m_minHeight = minHeight;
+    m_maxHeight = maxHeight;
+
+    // Enough levels for the root to cover the extent; 24 keeps every corner exact in a float
+    m_levels = 1;
+    while (m_levels < 24 && nodeSize(m_levels - 1) < extent) m_levels++;
+    m_rootSize = nodeSize(m_levels - 1);
+    setView(m_pixelsPerUnit, m_pixelError);
+}
+
+void LodQuadtree::setView(float pixelsPerUnit, float pixelError) {
+    m_pixelsPerUnit = pixelsPerUnit;
+    m_pixelError = pixelError;
+    m_ranges.assign(m_levels, 0.f);
+    m_morphStarts.assign(m_levels, 0.f);
+    m_morphEnds.assign(m_levels, 0.f);
+
+    for (int level = 0; level < m_levels; level++) {
+        // A quad of this level spans pixelError pixels at this distance
+        float screen = quadSize(level) * pixelsPerUnit / pixelError;
+        // A node reaches at most its diagonal past its range; morphing must not start that close,
+        // or a finer neighbour would meet vertices already sliding towards the next level
+        float diagonal = std::sqrt(2.f) * nodeSize(level);
+        float previous = level > 0 ? m_ranges[level - 1] : 0.f;
+        m_ranges[level] = std::max({screen, 2 * diagonal, 2 * previous});
+
+        m_morphStarts[level] = previous + (m_ranges[level] - previous) * kMorphStartRatio;
+        m_morphEnds[level] = m_ranges[level];
+    }
+    // Nothing coarser to morph into
+    m_morphStarts[m_levels - 1] = kNoMorph;
+    m_morphEnds[m_levels - 1] = 2 * kNoMorph;
+}
+
+glm::vec2 LodQuadtree::nodeOrigin(int level, int x, int y) const {
+    float size = nodeSize(level);
+    return glm::vec2(-m_rootSize / 2) + glm::vec2(x * size, y * size);
+}
+
+static bool boxIntersectsSphere(const glm::vec3 &lo, const glm::vec3 &hi, const glm::vec3 &center, float radius) {
+    glm::vec3 nearest = glm::clamp(center, lo, hi);
+    glm::vec3 d = nearest - center;
+    return glm::dot(d, d) <= radius * radius;
+}
+
+// True if the box is entirely behind one of the frustum planes
+static bool boxOutsideFrustum(const glm::vec3 &lo, const glm::vec3 &hi, const glm::vec4 *planes) {
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4 &p = planes[i];
+        glm::vec3 farthest(p.x >= 0 ? hi.x : lo.x, p.y >= 0 ? hi.y : lo.y, p.z >= 0 ? hi.z : lo.z);
+        if (glm::dot(glm::vec3(p), farthest) + p.w < 0) return true;
+    }
+    return false;
+}
+
+// Returns false if the node is beyond its level's range, leaving its area to the parent
+bool LodQuadtree::selectNode(int level, int x, int y, const glm::vec3 &camera, const glm::vec4 *planes,
+                             std::vector<LodNode> &out) const {
+    glm::vec2 origin = nodeOrigin(level, x, y);
+    glm::vec2 corner = origin + glm::vec2(nodeSize(level));
+    glm::vec3 flatLo(origin, lodHeight()), flatHi(corner, lodHeight());
+
+    if (!boxIntersectsSphere(flatLo, flatHi, camera, m_ranges[level])) return false;
+    // Culled nodes count as handled, so the parent does not draw them either
+    if (boxOutsideFrustum(glm::vec3(origin, m_minHeight), glm::vec3(corner, m_maxHeight), planes)) return true;
+
+    if (level == 0 || !boxIntersectsSphere(flatLo, flatHi, camera, m_ranges[level - 1])) {
+        out.push_back({level, x, y, kAllQuadrants});
+        return true;
+    }
+
+    // Children out of their range are drawn here instead, one quadrant each
+    uint8_t quadrants = 0;
+    for (int child = 0; child < 4; child++) {
+        if (!selectNode(level - 1, 2 * x + (child & 1), 2 * y + (child >> 1), camera, planes, out)) {
+            quadrants |= uint8_t(1 << child);
+        }
+    }
+    if (quadrants) out.push_back({level, x, y, quadrants});
+    return true;
+}
+
+void LodQuadtree::select(const glm::vec3 &camera, const glm::mat4 &viewProj, std::vector<LodNode> &out) const {
+    out.clear();
+
+    // Frustum planes straight from the matrix rows (Gribb & Hartmann), inside where dot >= 0
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    glm::vec4 planes[6] = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                           rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+
+    // The root is drawn however far away the camera is
+    int top = m_levels - 1;
+    if (!selectNode(top, 0, 0, camera, planes, out)) {
+        glm::vec2 origin = nodeOrigin(top, 0, 0);
+        if (!boxOutsideFrustum(glm::vec3(origin, m_minHeight),
+                               glm::vec3(origin + glm::vec2(m_rootSize), m_maxHeight), planes)) {
+            out.push_back({top, 0, 0, kAllQuadrants});
+        }
+    }
+}
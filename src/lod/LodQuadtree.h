@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Continuous distance-dependent LOD (CDLOD) over a square terrain.
+//
+// The terrain is a quadtree of nodes. Every node, whatever its level, is drawn with the same
+// gridSize x gridSize quad grid, so a node's quads are twice the size of its children's. Each frame
+// select() picks the coarsest nodes whose quads stay within pixelError pixels on screen, which keeps
+// the drawn vertex count roughly independent of the terrain's extent and finest detail.
+//
+// Levels count up from 0, the finest. Level l is used up to range(l) from the camera; over its last
+// stretch, from morphStart(l), its vertices slide onto the grid of level l + 1 (geomorphing), so they
+// meet the coarser neighbour exactly where one begins and no cracks open between levels.
+// These distances are measured to the plane at lodHeight(), not to the surface: the height bounds are
+// global and loose, and counting them would push every range out by the full height span.
+// Frustum culling does use the real bounds.
+//
+// All node corners and grid positions are multiples of the finest quad size, a power of two,
+// so neighbouring nodes compute bit-identical positions for the vertices they share.
+struct LodNode
+{
+    int level;
+    int x;            // node column and row within its level, from the terrain's minimum corner
+    int y;
+    uint8_t quadrants; // quadrants to draw at this level: bit 0 (-x -y), 1 (+x -y), 2 (-x +y), 3 (+x +y)
+};
+
+class LodQuadtree
+{
+public:
+    static constexpr uint8_t kAllQuadrants = 0xF;
+
+    // Covers at least `extent` world units centered on the origin, with quads of `finestQuadSize`
+    // (rounded down to a power of two) in the finest level. Heights lie in [minHeight, maxHeight].
+    void configure(float extent, float finestQuadSize, int gridSize, float minHeight, float maxHeight);
+
+    // Selection ranges for the view: `pixelsPerUnit` is the size in pixels of one world unit at
+    // distance 1 (viewport height * projection[1][1] / 2). Never below what crack-free morphing needs.
+    void setView(float pixelsPerUnit, float pixelError);
+
+    int levelCount() const { return m_levels; }
+    int gridSize() const { return m_gridSize; }
+    float rootSize() const { return m_rootSize; }
+    float nodeSize(int level) const { return m_finestQuadSize * m_gridSize * float(1 << level); }
+    float quadSize(int level) const { return m_finestQuadSize * float(1 << level); }
+    glm::vec2 nodeOrigin(int level, int x, int y) const;
+    // Nodes per side at `level`
+    int nodesPerSide(int level) const { return 1 << (m_levels - 1 - level); }
+
+    // Height of the plane LOD distances are measured to, midway between the height bounds
+    float lodHeight() const { return (m_minHeight + m_maxHeight) / 2; }
+    float range(int level) const { return m_ranges[level]; }
+    float morphStart(int level) const { return m_morphStarts[level]; }
+    float morphEnd(int level) const { return m_morphEnds[level]; }
+
+    // Nodes to draw this frame; `viewProj` culls them against the view frustum
+    void select(const glm::vec3 &camera, const glm::mat4 &viewProj, std::vector<LodNode> &out) const;
+
+private:
+    bool selectNode(int level, int x, int y, const glm::vec3 &camera, const glm::vec4 *planes,
+                    std::vector<LodNode> &out) const;
+
+    float m_finestQuadSize = 1.f / 32;
+    int m_gridSize = 32;
+    int m_levels = 1;
+    float m_rootSize = 1.f;
+    float m_minHeight = 0.f;
+    float m_maxHeight = 0.f;
+    float m_pixelsPerUnit = 1000.f;
+    float m_pixelError = 2.f;
+    std::vector<float> m_ranges;
+    std::vector<float> m_morphStarts;
+    std::vector<float> m_morphEnds;
+};
@@ -0,0 +1,132 @@
+#include "PlanetChunkBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/ext/scalar_constants.hpp"
+#include "noise/PerlinKernels.h"
+
+double PlanetChunkBuilder::minRadius() const {
+    return m_radius * (1 - m_heightScale * Perlin3D::fbmBound(m_maxOctaves));
+}
+
+double PlanetChunkBuilder::maxRadius() const {
+    return m_radius * (1 + m_heightScale * Perlin3D::fbmBound(m_maxOctaves));
+}
+
+int PlanetChunkBuilder::octaves(int depth, int gridSize) const {
+    // Octave o repeats every 1 / (baseFrequency * 2^o) along the unit sphere; a quad at `depth`
+    // spans about (pi / 2) / (gridSize * 2^depth) of it
+    double quad = (glm::pi<double>() / 2) / (double(gridSize) * std::exp2(depth));
+    int count = 0;
+    while (count < m_maxOctaves && 1.0 / (DefaultFbm::baseFrequency * std::exp2(count)) >= 2 * quad) count++;
+    return std::max(count, 1);
+}
+
+glm::dvec2 PlanetChunkBuilder::radiusBounds(const PlanetNode &node, int gridSize) const {
+    double size = node.size(), u0 = node.u0(), v0 = node.v0();
+    glm::dvec3 center = cubeSphereDirection(node.face, u0 + size / 2, v0 + size / 2);
+    double reach = 0; // farthest any of the patch's directions gets from the center one
+    for (int j = 0; j <= 2; j++) {
+        for (int i = 0; i <= 2; i++) {
+            reach = std::max(reach, glm::length(cubeSphereDirection(node.face, u0 + i * size / 2, v0 + j * size / 2) - center));
+        }
+    }
+
+    // Amplitude times frequency is the same for every DefaultFbm octave, so each coarse one
+    // changes by at most its gradient bound per unit of distance
+    int coarse = std::min(octaves(node.depth, gridSize), m_maxOctaves);
+    double slope = DefaultFbm::baseAmplitude * DefaultFbm::baseFrequency * Perlin3D::kGradientBound;
+    double spread = coarse * slope * reach + Perlin3D::fbmBound(m_maxOctaves) - Perlin3D::fbmBound(coarse);
+    double height = m_noise.fbm(center, coarse);
+    return m_radius * (1.0 + m_heightScale * glm::dvec2(height - spread, height + spread));
+}
+
+double PlanetChunkBuilder::surfaceRadius(const glm::dvec3 &direction, int octaves) const {
+    return m_radius * (1 + m_heightScale * m_noise.fbm(direction, octaves));
+}
+
+// Boundary vertices of the grid, counter-clockwise in (u, v) starting at (0, 0)
+static int boundaryVertex(int k, int gridSize) {
+    int side = gridSize + 1, edge = k / gridSize, t = k % gridSize;
+    switch (edge) {
+    case 0: return t;                                           // bottom, left to right
+    case 1: return t * side + gridSize;                         // right, bottom to top
+    case 2: return gridSize * side + (gridSize - t);            // top, right to left
+    default: return (gridSize - t) * side;                      // left, top to bottom
+    }
+}
+
+std::vector<uint16_t> PlanetChunkBuilder::indices(int gridSize) {
+    int side = gridSize + 1;
+    std::vector<uint16_t> indices;
+    indices.reserve(size_t(gridSize) * gridSize * 6 + size_t(gridSize) * 24);
+    // Same split as Terrain::makeTile()
+    for (int y = 0; y < gridSize; y++) {
+        for (int x = 0; x < gridSize; x++) {
+            uint16_t bottomLeft = uint16_t(y * side + x), bottomRight = bottomLeft + 1;
+            uint16_t topLeft = bottomLeft + side, topRight = topLeft + 1;
+            indices.insert(indices.end(), {topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight});
+        }
+    }
+    // Skirt quads hang from each boundary edge, facing away from the chunk
+    int skirt = side * side, ring = 4 * gridSize;
+    for (int k = 0; k < ring; k++) {
+        uint16_t a = uint16_t(boundaryVertex(k, gridSize)), b = uint16_t(boundaryVertex((k + 1) % ring, gridSize));
+        uint16_t lowA = uint16_t(skirt + k), lowB = uint16_t(skirt + (k + 1) % ring);
+        indices.insert(indices.end(), {a, lowA, lowB, a, lowB, b});
+    }
+    return indices;
+}
+
+glm::dvec3 PlanetChunkBuilder::build(const PlanetNode &node, int gridSize, void *out) {
+    int side = gridSize + 1;
+    int padded = gridSize + 3; // one ring of extra samples around the grid, for normals
+    int octaveCount = octaves(node.depth, gridSize);
+    double size = node.size(), u0 = node.u0(), v0 = node.v0();
+
+    m_directions.resize(size_t(padded) * padded);
+    m_positions.resize(m_directions.size());
+    double lowest = INFINITY, highest = 0;
+    for (int j = 0; j < padded; j++) {
+        for (int i = 0; i < padded; i++) {
+            // (i - 1) / gridSize is exact for a power-of-two grid, so shared edges sample the same points
+            double u = u0 + size * (i - 1) / gridSize, v = v0 + size * (j - 1) / gridSize;
+            glm::dvec3 direction = cubeSphereDirection(node.face, u, v);
+            double r = surfaceRadius(direction, octaveCount);
+            m_directions[size_t(j) * padded + i] = direction;
+            m_positions[size_t(j) * padded + i] = direction * r;
+            if (i > 0 && j > 0 && i <= side && j <= side) {
+                lowest = std::min(lowest, r);
+                highest = std::max(highest, r);
+            }
+        }
+    }
+
+    glm::dvec3 center = cubeSphereDirection(node.face, u0 + size / 2, v0 + size / 2) * m_radius;
+    auto sample = [&](int i, int j) { return m_positions[size_t(j + 1) * padded + (i + 1)]; };
+
+    MeshWriter<MeshVertexFormat> writer(out, vertexCount(gridSize));
+    m_normals.resize(size_t(side) * side);
+    for (int j = 0; j < side; j++) {
+        for (int i = 0; i < side; i++) {
+            glm::dvec3 du = sample(i + 1, j) - sample(i - 1, j);
+            glm::dvec3 dv = sample(i, j + 1) - sample(i, j - 1);
+            glm::vec3 normal = glm::vec3(glm::normalize(glm::cross(du, dv)));
+            m_normals[size_t(j) * side + i] = normal;
+            writer.write(j * side + i, glm::vec3(sample(i, j) - center), normal);
+        }
+    }
+
+    // Deep enough to cover the largest step to a coarser neighbour along any edge
+    double quad = m_radius * (glm::pi<double>() / 2) / (double(gridSize) * std::exp2(node.depth));
+    double skirtDepth = (highest - lowest) + quad;
+    for (int k = 0; k < 4 * gridSize; k++) {
+        int vertex = boundaryVertex(k, gridSize);
+        int i = vertex % side, j = vertex / side;
+        glm::dvec3 direction = m_directions[size_t(j + 1) * padded + (i + 1)];
+        glm::dvec3 low = sample(i, j) - direction * skirtDepth;
+        writer.write(side * side + k, glm::vec3(low - center), m_normals[vertex]);
+    }
+    return center;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "lod/PlanetQuadtree.h"
+#include "noise/Perlin3D.h"
+#include "shapes/Mesh.h"
+
+// Samples chunks of the cube-sphere planet: radius * (1 + heightScale * fbm(direction)).
+//
+// A chunk is a (gridSize + 1)^2 vertex grid plus a skirt, one extra vertex below each edge vertex,
+// in MeshVertexFormat. Positions are relative to the chunk's center, which build() returns in double
+// precision: the renderer adds it back relative to the camera, so even metre-sized quads on an
+// Earth-sized planet keep their float precision. Normals come from the displaced neighbours,
+// one sample ring beyond the chunk, so they agree across chunk edges.
+//
+// Octaves finer than two quads of a node would only alias, so a node samples octaves(depth) of them,
+// up to maxOctaves: every level down adds one more.
+class PlanetChunkBuilder
+{
+public:
+    void setRadius(double radius) { m_radius = radius; }
+    void setHeightScale(double scale) { m_heightScale = scale; }
+    void setMaxOctaves(int octaves) { m_maxOctaves = octaves; }
+    void setSeed(uint32_t seed) { m_noise.setTable(GradientTable::forSeed(seed)); }
+
+    double radius() const { return m_radius; }
+    int maxOctaves() const { return m_maxOctaves; }
+    // Bounds on the surface radius at any depth
+    double minRadius() const;
+    double maxRadius() const;
+    int octaves(int depth, int gridSize) const;
+    // Surface radius range over `node` at every depth below it, for PlanetQuadtree::setRadiusBounds():
+    // the coarse octaves sampled at its center plus their largest slope across it, and the
+    // finer octaves' full amplitude
+    glm::dvec2 radiusBounds(const PlanetNode &node, int gridSize) const;
+
+    static int vertexCount(int gridSize) { return (gridSize + 1) * (gridSize + 1) + 4 * gridSize; }
+    // Triangles of every chunk, grid first and then the skirt, counter-clockwise from outside
+    static std::vector<uint16_t> indices(int gridSize);
+
+    // Writes vertexCount(gridSize) vertices of `node` to `out` and returns the chunk's center
+    glm::dvec3 build(const PlanetNode &node, int gridSize, void *out);
+
+private:
+    double surfaceRadius(const glm::dvec3 &direction, int octaves) const;
+
+    Perlin3D m_noise;
+    double m_radius = 1.0;
+    double m_heightScale = 0.05;
+    int m_maxOctaves = 20;
+    std::vector<glm::dvec3> m_directions;
+    std::vector<glm::dvec3> m_positions;
+    std::vector<glm::vec3> m_normals;
+};
@@ -0,0 +1,125 @@
+#include "PlanetQuadtree.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/ext/scalar_constants.hpp"
+
+void PlanetQuadtree::configure(double radius, double minRadius, double maxRadius, int gridSize, int maxDepth) {
+    m_radius = radius;
+    m_minRadius = minRadius;
+    m_maxRadius = maxRadius;
+    m_gridSize = gridSize;
+    // Keeps x and y within PlanetNode::key()'s 28 bits; quads are already millimetres on Earth there
+    m_maxDepth = std::clamp(maxDepth, 0, 28);
+    m_radiusCache.clear();
+}
+
+void PlanetQuadtree::setView(double pixelsPerUnit, double pixelError) {
+    m_pixelsPerUnit = pixelsPerUnit;
+    m_pixelError = pixelError;
+}
+
+void PlanetQuadtree::setRadiusBounds(RadiusBounds bounds) {
+    m_radiusBounds = std::move(bounds);
+    m_radiusCache.clear();
+}
+
+double PlanetQuadtree::quadSize(int depth) const {
+    // A face spans a quarter of a great circle across its middle
+    return m_maxRadius * (glm::pi<double>() / 2) / (double(m_gridSize) * double(int64_t(1) << depth));
+}
+
+PlanetQuadtree::Bounds PlanetQuadtree::bounds(const PlanetNode &node) {
+    double size = node.size(), u0 = node.u0(), v0 = node.v0();
+    Bounds b;
+    b.axis = cubeSphereDirection(node.face, u0 + size / 2, v0 + size / 2);
+
+    // The patch is widest from its center at the corners and edge midpoints
+    b.cosAngle = 1.0;
+    for (int j = 0; j <= 2; j++) {
+        for (int i = 0; i <= 2; i++) {
+            glm::dvec3 d = cubeSphereDirection(node.face, u0 + i * size / 2, v0 + j * size / 2);
+            b.cosAngle = std::min(b.cosAngle, glm::dot(b.axis, d));
+        }
+    }
+    b.sinAngle = std::sqrt(std::max(0.0, 1 - b.cosAngle * b.cosAngle));
+
+    b.minRadius = m_minRadius;
+    b.maxRadius = m_maxRadius;
+    if (m_radiusBounds) {
+        // A frame mostly revisits last frame's nodes; starting over beats tracking which are stale
+        if (m_radiusCache.size() > (1 << 18)) m_radiusCache.clear();
+        auto [it, inserted] = m_radiusCache.try_emplace(node.key());
+        if (inserted) it->second = m_radiusBounds(node);
+        b.minRadius = std::max(b.minRadius, it->second.x);
+        b.maxRadius = std::min(b.maxRadius, it->second.y);
+    }
+    return b;
+}
+
+bool PlanetQuadtree::culled(const Bounds &b, const glm::dvec3 &camera, const glm::dvec4 *planes) const {
+    double d = glm::length(camera);
+    double angle = std::acos(std::clamp(glm::dot(b.axis, camera / d), -1.0, 1.0));
+    double nearestAngle = angle - std::acos(b.cosAngle); // from the camera direction to the patch
+
+    // A peak of the patch can be seen at most acos(min / max) past the point below the camera...
+    double peak = std::acos(m_minRadius / b.maxRadius);
+    if (nearestAngle > glm::pi<double>() / 2 + peak) return true;
+    // ...beyond the horizon seen from the camera, over the lowest possible surface
+    if (d > m_minRadius && nearestAngle > std::acos(m_minRadius / d) + peak) return true;
+
+    // Bounding sphere of the cone section between the patch's two radii
+    double h = (b.minRadius * b.cosAngle + b.maxRadius) / 2;
+    glm::dvec3 center = b.axis * h;
+    double r = std::max(std::abs(b.maxRadius - h), std::abs(h - b.minRadius * b.cosAngle));
+    for (double rim : {b.minRadius, b.maxRadius}) {
+        r = std::max(r, std::hypot(rim * b.cosAngle - h, rim * b.sinAngle));
+    }
+    for (int i = 0; i < 6; i++) {
+        const glm::dvec4 &p = planes[i];
+        if (glm::dot(glm::dvec3(p), center) + p.w < -r * glm::length(glm::dvec3(p))) return true;
+    }
+    return false;
+}
+
+// Nearest distance from the camera to any point of the patch's cone section (a lower bound)
+double PlanetQuadtree::distance(const Bounds &b, const glm::dvec3 &camera) const {
+    double d = glm::length(camera);
+    double cosCamera = std::clamp(glm::dot(b.axis, camera / d), -1.0, 1.0);
+    double nearestAngle = std::max(0.0, std::acos(cosCamera) - std::acos(b.cosAngle));
+    double cosNearest = std::cos(nearestAngle);
+    double r = std::clamp(d * cosNearest, b.minRadius, b.maxRadius);
+    return std::sqrt(std::max(0.0, d * d + r * r - 2 * d * r * cosNearest));
+}
+
+void PlanetQuadtree::selectNode(const PlanetNode &node, const glm::dvec3 &camera, const glm::dvec4 *planes,
+                                std::vector<PlanetNode> &out) {
+    Bounds b = bounds(node);
+    if (culled(b, camera, planes)) return;
+
+    // Split while a quad would cover more than pixelError pixels at the nearest point
+    double pixels = quadSize(node.depth) * m_pixelsPerUnit / std::max(distance(b, camera), 1e-12);
+    if (node.depth < m_maxDepth && pixels > m_pixelError) {
+        for (int child = 0; child < 4; child++) {
+            PlanetNode c{node.face, node.depth + 1, 2 * node.x + (child & 1), 2 * node.y + (child >> 1)};
+            selectNode(c, camera, planes, out);
+        }
+        return;
+    }
+    out.push_back(node);
+}
+
+void PlanetQuadtree::select(const glm::dvec3 &camera, const glm::dmat4 &viewProj, std::vector<PlanetNode> &out) {
+    out.clear();
+
+    // Frustum planes from the matrix rows, as in LodQuadtree::select()
+    glm::dvec4 rows[4];
+    for (int i = 0; i < 4; i++) rows[i] = glm::dvec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    glm::dvec4 planes[6] = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                            rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+
+    for (int face = 0; face < kCubeFaces; face++) {
+        selectNode({face, 0, 0, 0}, camera, planes, out);
+    }
+}
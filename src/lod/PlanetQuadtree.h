@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "lod/CubeSphere.h"
+
+// One chunk of the cube-sphere planet: square (x, y) of a face's 2^depth x 2^depth split
+struct PlanetNode
+{
+    int face;
+    int depth;  // 0 is the whole face
+    int x;
+    int y;
+
+    // The node's [u0, u0 + size] x [v0, v0 + size] square of the face
+    double size() const { return 2.0 / double(int64_t(1) << depth); }
+    double u0() const { return -1.0 + x * size(); }
+    double v0() const { return -1.0 + y * size(); }
+
+    // Unique per node up to PlanetQuadtree's depth limit
+    uint64_t key() const { return uint64_t(face) << 61 | uint64_t(depth) << 56 | uint64_t(x) << 28 | uint64_t(y); }
+};
+
+// Chunked LOD over the six faces of a cube-sphere planet (see CubeSphere.h).
+//
+// Each face is the root of a quadtree. select() splits a node while one of its gridSize x gridSize
+// quads would cover more than pixelError pixels at the node's nearest point, so detail follows the
+// camera down to maxDepth while the drawn chunk count stays bounded. Levels are not geomorphed;
+// chunks hang skirts below their edges instead, which hides the gaps where neighbours differ.
+//
+// Nodes are culled before they are split: against the view frustum, when the whole patch lies on
+// the far hemisphere (backface), and when it lies behind the planet's horizon as seen from the camera.
+// All three tests, and the split distance, use the node's own radius range when setRadiusBounds()
+// provides one; the planet-wide range alone keeps every node near a low camera inside the frustum.
+class PlanetQuadtree
+{
+public:
+    // Surface radii lie in [minRadius, maxRadius]; `radius` is the undisplaced sphere
+    void configure(double radius, double minRadius, double maxRadius, int gridSize, int maxDepth);
+    // As LodQuadtree::setView()
+    void setView(double pixelsPerUnit, double pixelError);
+    // Surface radius range (min, max) of a node and all of its descendants. Results are cached until
+    // the next configure() or setRadiusBounds().
+    using RadiusBounds = std::function<glm::dvec2(const PlanetNode &)>;
+    void setRadiusBounds(RadiusBounds bounds);
+
+    double radius() const { return m_radius; }
+    double minRadius() const { return m_minRadius; }
+    double maxRadius() const { return m_maxRadius; }
+    int gridSize() const { return m_gridSize; }
+    int maxDepth() const { return m_maxDepth; }
+    // Length of one quad's edge at `depth`, at the face center where quads are largest
+    double quadSize(int depth) const;
+
+    // Chunks to draw for a camera at `camera` (planet centered at the origin). `viewProj` maps
+    // planet coordinates to clip space.
+    void select(const glm::dvec3 &camera, const glm::dmat4 &viewProj, std::vector<PlanetNode> &out);
+
+private:
+    // A node's patch, bounded by a cone around `axis` and the radius range
+    struct Bounds
+    {
+        glm::dvec3 axis;
+        double cosAngle;  // cosine of the cone's half-angle
+        double sinAngle;
+        double minRadius;
+        double maxRadius;
+    };
+
+    Bounds bounds(const PlanetNode &node);
+    bool culled(const Bounds &b, const glm::dvec3 &camera, const glm::dvec4 *planes) const;
+    double distance(const Bounds &b, const glm::dvec3 &camera) const;
+    void selectNode(const PlanetNode &node, const glm::dvec3 &camera, const glm::dvec4 *planes,
+                    std::vector<PlanetNode> &out);
+
+    double m_radius = 1.0;
+    double m_minRadius = 1.0;
+    double m_maxRadius = 1.0;
+    int m_gridSize = 32;
+    int m_maxDepth = 16;
+    double m_pixelsPerUnit = 1000.0;
+    double m_pixelError = 4.0;
+    RadiusBounds m_radiusBounds;
+    std::unordered_map<uint64_t, glm::dvec2> m_radiusCache;
+};
@@ -0,0 +1,182 @@
+#include "lodrenderer.h"
+
+#include <QOpenGLShaderProgram>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+
+#include "vertexattributes.h"
+
+// Largest on-screen size of a quad, in pixels, before a finer level takes over
+static constexpr float kPixelError = 8.f;
+// Vertex slots allocated up front; the pool doubles them whenever one frame needs more
+static constexpr int kInitialSlots = 256;
+
+static const char *lodVertexShaderSource =
+    "layout(location = 0) in vec2 gridPos;\n"
+    "layout(location = 1) in vec2 heights;\n"    // here, and at the coarser vertex this one collapses onto
+    "layout(location = 2) in vec4 octNormals;\n" // likewise
+    "out vec3 vert;\n"
+    "out vec3 vertNormal;\n"
+    "uniform vec2 nodeOrigin;\n"
+    "uniform float quadSize;\n"
+    "uniform vec2 morphRange;\n"  // distances where morphing into the coarser level starts and ends
+    "uniform vec3 cameraPos;\n"   // in terrain coordinates
+    "uniform float lodHeight;\n"  // LOD distances are to the plane at this height, as in LodQuadtree
+    "uniform mat4 projMatrix;\n"
+    "uniform mat4 mvMatrix;\n"
+    "uniform mat3 normalMatrix;\n"
+    "void main() {\n"
+    "   vec2 xy = nodeOrigin + gridPos * quadSize;\n"
+    "   float k = clamp((distance(cameraPos, vec3(xy, lodHeight)) - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);\n"
+    "   xy -= mod(gridPos, 2.0) * quadSize * k;\n"
+    "   vec4 position = vec4(xy, mix(heights.x, heights.y, k), 1.0);\n"
+    "   vec3 normal = normalize(mix(octDecode(octNormals.xy), octDecode(octNormals.zw), k));\n"
+    "   vert = vec3(mvMatrix * position);\n"
+    "   vertNormal = normalMatrix * normal;\n"
+    "   gl_Position = projMatrix * mvMatrix * position;\n"
+    "}\n";
+
+void LodRenderer::create()
+{
+    initializeOpenGLFunctions();
+
+    m_program = new QOpenGLShaderProgram;
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, glslSource({octDecodeSource, lodVertexShaderSource}).c_str());
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, glslSource({shadeSource, pointLitFragmentSource}).c_str());
+    m_program->link();
+    m_program->bind();
+    m_program->setUniformValue("lightPos", QVector3D(70, 70, 70));
+    m_program->release();
+
+    // Shared grid indices: quadrant by quadrant in LodNode bit order, each tile split along the
+    // same diagonal as Terrain's. A collapsed odd vertex then folds every fine triangle onto one
+    // of the coarser grid's, or to nothing.
+    int half = kGridSize / 2, side = kGridSize + 1;
+    std::vector<uint16_t> indices;
+    for (int quadrant = 0; quadrant < 4; quadrant++) {
+        int x0 = (quadrant & 1) * half, y0 = (quadrant >> 1) * half;
+        for (int y = y0; y < y0 + half; y++) {
+            for (int x = x0; x < x0 + half; x++) {
+                uint16_t bottomLeft = uint16_t(y * side + x), bottomRight = bottomLeft + 1;
+                uint16_t topLeft = bottomLeft + side, topRight = topLeft + 1;
+                indices.insert(indices.end(), {topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight});
+            }
+        }
+    }
+    m_quadrantIndices = int(indices.size() / 4);
+
+    m_vao.create();
+    m_vao.bind();
+    glGenBuffers(1, &m_indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indices.size() * sizeof(uint16_t)), indices.data(), GL_STATIC_DRAW);
+
+    m_pool.create(GLsizeiptr(ChunkBuilder::vertexCount(kGridSize) * ChunkVertexFormat::stride), kInitialSlots,
+                  &setVertexAttributes<ChunkVertexFormat>);
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LodRenderer::destroy()
+{
+    delete m_program;
+    m_program = nullptr;
+    m_pool.destroy();
+    glDeleteBuffers(1, &m_indexBuffer);
+    m_indexBuffer = 0;
+    m_vao.destroy();
+}
+
+void LodRenderer::configure(float extent, int octaves)
+{
+    if (extent == m_extent && octaves == m_octaves) return;
+    m_extent = extent;
+    m_octaves = octaves;
+
+    m_builder.setOctaves(octaves);
+    float bound = m_builder.heightBound();
+    m_tree.configure(extent, kFinestQuadSize, kGridSize, -bound, bound);
+
+    m_pool.clear();
+}
+
+uint64_t LodRenderer::chunkKey(const LodNode &node)
+{
+    return uint64_t(node.level) << 48 | uint64_t(uint32_t(node.x)) << 24 | uint64_t(uint32_t(node.y));
+}
+
+void LodRenderer::drawNode(const LodNode &node, int slot)
+{
+    glm::vec2 origin = m_tree.nodeOrigin(node.level, node.x, node.y);
+    m_program->setUniformValue("nodeOrigin", QVector2D(origin.x, origin.y));
+    m_program->setUniformValue("quadSize", m_tree.quadSize(node.level));
+    m_program->setUniformValue("morphRange", QVector2D(m_tree.morphStart(node.level), m_tree.morphEnd(node.level)));
+
+    // One draw per run of consecutive quadrants
+    GLint baseVertex = slot * ChunkBuilder::vertexCount(kGridSize);
+    for (int quadrant = 0; quadrant < 4;) {
+        if (!(node.quadrants & (1 << quadrant))) {
+            quadrant++;
+            continue;
+        }
+        int first = quadrant;
+        while (quadrant < 4 && (node.quadrants & (1 << quadrant))) quadrant++;
+        GLsizei count = GLsizei((quadrant - first) * m_quadrantIndices);
+        glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_SHORT,
+                                 reinterpret_cast<void *>(first * m_quadrantIndices * sizeof(uint16_t)), baseVertex);
+    }
+}
+
+void LodRenderer::render(const glm::mat4 &proj, const glm::mat4 &modelView, int viewportHeight, bool wireframe)
+{
+    m_pool.beginFrame();
+
+    // One world unit at distance 1 covers this many pixels
+    float pixelsPerUnit = viewportHeight * proj[1][1] / 2;
+    if (pixelsPerUnit != m_pixelsPerUnit) {
+        m_pixelsPerUnit = pixelsPerUnit;
+        m_tree.setView(pixelsPerUnit, kPixelError);
+    }
+    glm::vec3 camera = glm::vec3(glm::inverse(modelView)[3]);
+    m_tree.select(camera, proj * modelView, m_selection);
+
+    m_vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, m_pool.bufferId());
+
+    // Mark every resident node used first, so none of them is evicted for a later one
+    m_slots.resize(m_selection.size());
+    for (size_t i = 0; i < m_selection.size(); i++) m_slots[i] = m_pool.find(chunkKey(m_selection[i]));
+    for (size_t i = 0; i < m_selection.size(); i++) {
+        if (m_slots[i] >= 0) continue;
+        const LodNode &node = m_selection[i];
+        m_slots[i] = m_pool.insert(chunkKey(node));
+        m_staging.resize(size_t(ChunkBuilder::vertexCount(kGridSize) * ChunkVertexFormat::stride));
+        m_builder.build(m_tree, node.level, node.x, node.y, m_staging.data());
+        m_pool.upload(m_slots[i], m_staging.data());
+    }
+
+    m_program->bind();
+    m_program->setUniformValue("projMatrix", toQMatrix(proj));
+    m_program->setUniformValue("mvMatrix", toQMatrix(modelView));
+    m_program->setUniformValue("normalMatrix", toQMatrix(modelView).normalMatrix());
+    m_program->setUniformValue("cameraPos", QVector3D(camera.x, camera.y, camera.z));
+    m_program->setUniformValue("lodHeight", m_tree.lodHeight());
+
+    int passes = wireframe ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        bool lines = pass == 1;
+        m_program->setUniformValue("wireframe", lines);
+        glPolygonMode(GL_FRONT_AND_BACK, lines ? GL_LINE : GL_FILL);
+        if (lines) {
+            glEnable(GL_POLYGON_OFFSET_LINE);
+            glPolygonOffset(-1, -1);
+        }
+        for (size_t i = 0; i < m_selection.size(); i++) drawNode(m_selection[i], m_slots[i]);
+    }
+    glDisable(GL_POLYGON_OFFSET_LINE);
+    glPolygonOffset(0, 0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    m_program->release();
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
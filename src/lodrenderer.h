@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLVertexArrayObject>
+
+#include "chunkpool.h"
+#include "lod/ChunkBuilder.h"
+#include "lod/LodQuadtree.h"
+
+QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
+
+// Draws the terrain as CDLOD chunks (see LodQuadtree) instead of one uploaded mesh.
+//
+// Every node is the same (gridSize + 1)^2 vertex grid, so all nodes share one index buffer, laid out
+// quadrant by quadrant so a partly drawn node is one or two ranges of it. Node vertices live in a
+// ChunkPool, so a node is only sampled again after it has gone unused long enough to be evicted.
+// Needs a current GL context throughout.
+class LodRenderer : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    static constexpr int kGridSize = 32;
+    static constexpr float kFinestQuadSize = 1.f / 32;
+
+    void create();
+    void destroy();
+
+    // Terrain `extent` units across with `octaves` of noise; any change drops every cached chunk
+    void configure(float extent, int octaves);
+    const LodQuadtree &quadtree() const { return m_tree; }
+
+    // `modelView` maps terrain coordinates (z up) to the eye
+    void render(const glm::mat4 &proj, const glm::mat4 &modelView, int viewportHeight, bool wireframe);
+
+private:
+    static uint64_t chunkKey(const LodNode &node);
+    void drawNode(const LodNode &node, int slot);
+
+    LodQuadtree m_tree;
+    ChunkBuilder m_builder;
+    float m_extent = 0.f;
+    float m_pixelsPerUnit = 0.f;
+    int m_octaves = 0;
+
+    QOpenGLShaderProgram *m_program = nullptr;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_indexBuffer = 0;
+    int m_quadrantIndices = 0; // indices per quadrant
+    ChunkPool m_pool;
+    std::vector<unsigned char> m_staging;
+
+    std::vector<LodNode> m_selection;
+    std::vector<int> m_slots; // m_selection's vertex slots
+};
@@ -5,9 +5,12 @@
 #include <QVBoxLayout>
 
 #include <QLabel>
+#include <QTimer>
 #include <QGroupBox>
 #include <iostream>
 
+#include "shapes/Icosphere.h"
+
 void MainWindow::setupUI()
 {
     // Create glWidget for OpenGL stuff
@@ -56,12 +59,12 @@ void MainWindow::setupUI()
 //    triangleCB->setText(QStringLiteral("Triangle"));
 //    triangleCB->setChecked(true); // Default Triangle toggled
 
-    cubeCB = new QRadioButton(); // Cube button
-    cubeCB->setText(QStringLiteral("Cube"));
+    cubeCB = new QRadioButton(); // Terrain button
+    cubeCB->setText(QStringLiteral("Terrain"));
     cubeCB->setChecked(true); // Default Triangle toggled
 
-//    sphereCB = new QRadioButton(); // Sphere button
-//    sphereCB->setText(QStringLiteral("Sphere"));
+    sphereCB = new QRadioButton(); // Icosphere button
+    sphereCB->setText(QStringLiteral("Icosphere"));
 
 //    cylinderCB = new QRadioButton(); // Cylinder button
 //    cylinderCB->setText(QStringLiteral("Cylinder"));
@@ -74,6 +77,65 @@ void MainWindow::setupUI()
     showWireframeNormals->setText(QStringLiteral("Show Wireframe and Normals"));
     showWireframeNormals->setChecked(true);
 
+    // Create toggle for the compact vertex format
+    compactVertices = new QCheckBox();
+    compactVertices->setText(QStringLiteral("Compact Vertices (8 bytes)"));
+    compactVertices->setChecked(settings.compactVertices);
+
+    // Create the render mode toggles and the LOD terrain's size
+    QGroupBox *renderLayout = new QGroupBox(); // exclusive render mode buttons
+    QVBoxLayout *lr = new QVBoxLayout();
+    meshMode = new QRadioButton();
+    meshMode->setText(QStringLiteral("Render Mesh"));
+    meshMode->setChecked(settings.renderMode == RENDER_MESH);
+    lodMode = new QRadioButton();
+    lodMode->setText(QStringLiteral("Render CDLOD Chunks"));
+    lodMode->setChecked(settings.renderMode == RENDER_LOD);
+    planetMode = new QRadioButton();
+    planetMode->setText(QStringLiteral("Render Planet"));
+    planetMode->setChecked(settings.renderMode == RENDER_PLANET);
+    heightmapMode = new QRadioButton();
+    heightmapMode->setText(QStringLiteral("Render GPU Heightmap"));
+    heightmapMode->setChecked(settings.renderMode == RENDER_HEIGHTMAP);
+    tessTerrainMode = new QRadioButton();
+    tessTerrainMode->setText(QStringLiteral("Render Tessellated Terrain"));
+    tessTerrainMode->setChecked(settings.renderMode == RENDER_TESSELLATED_TERRAIN);
+    tessPlanetMode = new QRadioButton();
+    tessPlanetMode->setText(QStringLiteral("Render Tessellated Planet"));
+    tessPlanetMode->setChecked(settings.renderMode == RENDER_TESSELLATED_PLANET);
+    clipmapMode = new QRadioButton();
+    clipmapMode->setText(QStringLiteral("Render Geometry Clipmap (WASD to move)"));
+    clipmapMode->setChecked(settings.renderMode == RENDER_CLIPMAP);
+    streamMode = new QRadioButton();
+    streamMode->setText(QStringLiteral("Render Streamed Chunks (WASD to move)"));
+    streamMode->setChecked(settings.renderMode == RENDER_STREAM);
+
+    lodExtentBox = new QSpinBox(); // LOD terrain side, 10 * 2^n
+    lodExtentBox->setMinimum(0);
+    lodExtentBox->setMaximum(10);
+    lodExtentBox->setSingleStep(1);
+    lodExtentBox->setValue(settings.lodExtent);
+    lodExtentBox->setPrefix("LOD Extent: 10 x 2^");
+
+    // The chunk streamer's counters, refreshed twice a second while its mode is on
+    streamStats = new QLabel();
+    streamStats->setVisible(settings.renderMode == RENDER_STREAM);
+    QTimer *streamTimer = new QTimer(this);
+    connect(streamTimer, &QTimer::timeout, this, &MainWindow::updateStreamStats);
+    streamTimer->start(500);
+
+    lr->addWidget(meshMode);
+    lr->addWidget(heightmapMode);
+    lr->addWidget(tessTerrainMode);
+    lr->addWidget(lodMode);
+    lr->addWidget(lodExtentBox);
+    lr->addWidget(clipmapMode);
+    lr->addWidget(streamMode);
+    lr->addWidget(streamStats);
+    lr->addWidget(planetMode);
+    lr->addWidget(tessPlanetMode);
+    renderLayout->setLayout(lr);
+
     // Creates the boxes containing the parameter sliders and number boxes
     QGroupBox *p1Layout = new QGroupBox(); // horizonal slider 1 alignment
     QHBoxLayout *l1 = new QHBoxLayout();
@@ -105,6 +167,13 @@ void MainWindow::setupUI()
     p2Box->setSingleStep(1);
     p2Box->setValue(1);
 
+    octavesBox = new QSpinBox(); // Octaves of terrain noise
+    octavesBox->setMinimum(1);
+    octavesBox->setMaximum(12);
+    octavesBox->setSingleStep(1);
+    octavesBox->setValue(settings.octaves);
+    octavesBox->setPrefix("Octaves: ");
+
     // Adds the slider and number box to the parameter layouts
     l1->addWidget(p1Slider);
     l1->addWidget(p1Box);
@@ -117,8 +186,8 @@ void MainWindow::setupUI()
     // Add the labels and checkbox widgets to vLayout for vertical alignment (order matters!)
 //    vLayout->addWidget(trimesh_label);
 //    vLayout->addWidget(triangleCB);
-//    vLayout->addWidget(cubeCB);
-//    vLayout->addWidget(sphereCB);
+    vLayout->addWidget(cubeCB);
+    vLayout->addWidget(sphereCB);
 //    vLayout->addWidget(cylinderCB);
 //    vLayout->addWidget(coneCB);
 //    vLayout->addWidget(width_spacer);
@@ -127,21 +196,27 @@ void MainWindow::setupUI()
     vLayout->addWidget(p1Layout);
 //    vLayout->addWidget(param2_label);
 //    vLayout->addWidget(p2Layout);
+    vLayout->addWidget(octavesBox);
     vLayout->addWidget(showWireframeNormals);
+    vLayout->addWidget(compactVertices);
+    vLayout->addWidget(renderLayout);
 
     // Connects the sliders and number boxes for the parameters
     connectParam1();
     connectParam2();
+    connectOctaves();
 
     // Connects the toggles for the shapes
 //    connectTriangle();
     connectCube();
-//    connectSphere();
+    connectSphere();
 //    connectCone();
 //    connectCylinder();
 
     // Connects the toggle for showing wireframe / normals
     connectWireframeNormals();
+    connectCompactVertices();
+    connectRenderMode();
 }
 
 //******************************** Handles Parameter 1 UI Changes ********************************//
@@ -176,6 +251,19 @@ void MainWindow::onValChangeP2(int newValue)
     glWidget->settingsChange();
 }
 
+//******************************** Handles Octaves UI Changes ********************************//
+void MainWindow::connectOctaves()
+{
+    connect(octavesBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this, &MainWindow::onOctavesChange);
+}
+
+void MainWindow::onOctavesChange(int newValue)
+{
+    settings.octaves = newValue;
+    glWidget->settingsChange();
+}
+
 //******************************** Handles Shape Type UI Changes ********************************//
 // triangle
 //void MainWindow::connectTriangle()
@@ -203,6 +291,9 @@ void MainWindow::onCubeChange()
 {
     settings.shapeType = SHAPE_CUBE;
     p1Slider->setMinimum(1);
+    p1Box->setMinimum(1);
+    p1Slider->setMaximum(50);
+    p1Box->setMaximum(50);
     p2Slider->setMinimum(1);
     p1Slider->setValue(1);
     p2Slider->setValue(1);
@@ -210,20 +301,22 @@ void MainWindow::onCubeChange()
 }
 
 // sphere
-//void MainWindow::connectSphere()
-//{
-//    connect(sphereCB, &QRadioButton::clicked, this, &MainWindow::onSphereChange);
-//}
+void MainWindow::connectSphere()
+{
+    connect(sphereCB, &QRadioButton::clicked, this, &MainWindow::onSphereChange);
+}
 
-//void MainWindow::onSphereChange()
-//{
-//    settings.shapeType = SHAPE_SPHERE;
-//    p1Slider->setMinimum(2);
-//    p2Slider->setMinimum(3);
-//    p1Slider->setValue(2);
-//    p2Slider->setValue(3);
-//    glWidget->settingsChange();
-//}
+void MainWindow::onSphereChange()
+{
+    // Parameter 1 is the subdivision level
+    settings.shapeType = SHAPE_SPHERE;
+    p1Slider->setMinimum(0);
+    p1Box->setMinimum(0);
+    p1Slider->setMaximum(Icosphere::kMaxSubdivisions);
+    p1Box->setMaximum(Icosphere::kMaxSubdivisions);
+    p1Slider->setValue(3);
+    glWidget->settingsChange();
+}
 
 //// cylinder
 //void MainWindow::connectCylinder()
@@ -269,6 +362,67 @@ void MainWindow::onWireframeNormalsChange()
     glWidget->settingsChange();
 }
 
+//****************************** Handles Vertex Format UI Changes ******************************//
+void MainWindow::connectCompactVertices()
+{
+    connect(compactVertices, &QCheckBox::clicked, this, &MainWindow::onCompactVerticesChange);
+}
+
+void MainWindow::onCompactVerticesChange()
+{
+    settings.compactVertices = !settings.compactVertices;
+    glWidget->settingsChange();
+}
+
+//******************************** Handles Render Mode UI Changes ********************************//
+void MainWindow::connectRenderMode()
+{
+    connect(meshMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(lodMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(planetMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(heightmapMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(tessTerrainMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(tessPlanetMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(clipmapMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(streamMode, &QRadioButton::clicked, this, &MainWindow::onRenderModeChange);
+    connect(lodExtentBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this, &MainWindow::onLodExtentChange);
+}
+
+void MainWindow::onRenderModeChange()
+{
+    if (lodMode->isChecked()) settings.renderMode = RENDER_LOD;
+    else if (planetMode->isChecked()) settings.renderMode = RENDER_PLANET;
+    else if (heightmapMode->isChecked()) settings.renderMode = RENDER_HEIGHTMAP;
+    else if (tessTerrainMode->isChecked()) settings.renderMode = RENDER_TESSELLATED_TERRAIN;
+    else if (tessPlanetMode->isChecked()) settings.renderMode = RENDER_TESSELLATED_PLANET;
+    else if (clipmapMode->isChecked()) settings.renderMode = RENDER_CLIPMAP;
+    else if (streamMode->isChecked()) settings.renderMode = RENDER_STREAM;
+    else settings.renderMode = RENDER_MESH;
+    streamStats->setVisible(settings.renderMode == RENDER_STREAM);
+    glWidget->settingsChange();
+}
+
+void MainWindow::onLodExtentChange(int newValue)
+{
+    settings.lodExtent = newValue;
+    glWidget->settingsChange();
+}
+
+void MainWindow::updateStreamStats()
+{
+    const ChunkStreamer *streamer = glWidget->streamer();
+    if (!streamStats->isVisible() || !streamer) return;
+    ChunkStreamer::Counters c = streamer->counters();
+    streamStats->setText(QString::asprintf("Hit rate %.1f%% (%llu hits, %llu misses)\n"
+                                           "Sampling %.2f ms, latency %.1f ms (max %.1f)\n"
+                                           "%d cached, %d queued, %llu evicted",
+                                           100 * c.hitRate(), (unsigned long long)c.hits,
+                                           (unsigned long long)c.misses, c.meanBuildMs(), c.meanLatencyMs(),
+                                           1e3 * c.maxLatencySeconds, c.cached, c.queued,
+                                           (unsigned long long)c.evicted));
+}
+
 MainWindow::~MainWindow()
 {
     delete(glWidget);
@@ -277,8 +431,19 @@ MainWindow::~MainWindow()
     delete(p2Box);
 //    delete(triangleCB);
     delete(cubeCB);
-//    delete(sphereCB);
+    delete(sphereCB);
 //    delete(cylinderCB);
 //    delete(coneCB);
     delete(showWireframeNormals);
+    delete(compactVertices);
+    delete(meshMode);
+    delete(lodMode);
+    delete(planetMode);
+    delete(heightmapMode);
+    delete(tessTerrainMode);
+    delete(tessPlanetMode);
+    delete(clipmapMode);
+    delete(streamMode);
+    delete(streamStats);
+    delete(lodExtentBox);
 }
@@ -5,6 +5,7 @@
 #include <QSpinBox>
 #include <QRadioButton>
 #include <QCheckBox>
+#include <QLabel>
 
 #include "glwidget.h"
 
@@ -23,32 +24,52 @@ private:
     QSlider *p2Slider;
     QSpinBox *p1Box;
     QSpinBox *p2Box;
+    QSpinBox *octavesBox;
     QCheckBox *showWireframeNormals;
+    QCheckBox *compactVertices;
+    QRadioButton *meshMode;
+    QRadioButton *lodMode;
+    QRadioButton *planetMode;
+    QRadioButton *heightmapMode;
+    QRadioButton *tessTerrainMode;
+    QRadioButton *tessPlanetMode;
+    QRadioButton *clipmapMode;
+    QRadioButton *streamMode;
+    QSpinBox *lodExtentBox;
+    QLabel *streamStats;
 
 //    QRadioButton *triangleCB;
     QRadioButton *cubeCB;
-//    QRadioButton *sphereCB;
+    QRadioButton *sphereCB;
 //    QRadioButton *cylinderCB;
 //    QRadioButton *coneCB;
 
     void connectParam1();
     void connectParam2();;
+    void connectOctaves();
     void connectWireframeNormals();
+    void connectCompactVertices();
+    void connectRenderMode();
 
 //    void connectTriangle();
     void connectCube();
-//    void connectSphere();
+    void connectSphere();
 //    void connectCylinder();
 //    void connectCone();
 
 private slots:
     void onValChangeP1(int newValue);
     void onValChangeP2(int newValue);
+    void onOctavesChange(int newValue);
     void onWireframeNormalsChange();
+    void onCompactVerticesChange();
+    void onRenderModeChange();
+    void onLodExtentChange(int newValue);
+    void updateStreamStats();
 
 //    void onTriChange();
     void onCubeChange();
-//    void onSphereChange();
+    void onSphereChange();
 //    void onCylinderChange();
 //    void onConeChange();
 };
@@ -0,0 +1,104 @@
+#include "meshworker.h"
+
+MeshWorker::MeshWorker(std::function<void()> meshReady)
+    : m_meshReady(std::move(meshReady))
+{
+    m_thread = std::thread(&MeshWorker::run, this);
+}
+
+MeshWorker::~MeshWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        m_latest++; // cancels the job in flight
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void MeshWorker::request(const Settings &snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_request = snapshot;
+        m_hasRequest = true;
+        m_latest++;
+    }
+    m_wake.notify_one();
+}
+
+MeshPtr MeshWorker::takeMesh()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_mesh);
+}
+
+HeightfieldPtr MeshWorker::takeHeightfield()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_heightfield);
+}
+
+void MeshWorker::run()
+{
+    while (true) {
+        Settings snapshot;
+        uint64_t generation;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_quit || m_hasRequest; });
+            if (m_quit) return;
+
+            snapshot = m_request;
+            generation = m_latest;
+            m_hasRequest = false;
+        }
+
+        // Stale as soon as anything newer has been requested
+        CancelToken cancel([this, generation] { return m_latest != generation; });
+
+        bool heightmap = snapshot.renderMode == RENDER_HEIGHTMAP;
+        if (snapshot.shapeType == SHAPE_SPHERE && !heightmap) {
+            m_icosphere.setThreadCount(snapshot.workerThreads);
+            if (m_icosphere.updateParams(snapshot.shapeParameter1, cancel)) {
+                publish(generation, m_icosphere.generateShape());
+            }
+            continue;
+        }
+
+        m_terrain.setThreadCount(snapshot.workerThreads);
+        m_terrain.setOctaves(snapshot.octaves);
+        int previousTiles = 0;
+        for (int divisor : kRefinementDivisors) {
+            // Small parameters can give the same tile count at several levels
+            int tiles = Terrain::tileCount(snapshot.shapeParameter1, divisor);
+            if (tiles == previousTiles) continue;
+            previousTiles = tiles;
+
+            m_terrain.setResolutionDivisor(divisor);
+            if (heightmap) {
+                // A copy, as the terrain reuses its heightfield for the next refinement
+                if (!m_terrain.updateHeightfield(snapshot.shapeParameter1, cancel)) break;
+                if (!publish(generation, nullptr, std::make_shared<const Heightfield>(m_terrain.heightfield()))) break;
+                continue;
+            }
+            if (!m_terrain.updateParams(snapshot.shapeParameter1, cancel)) break;
+            if (!publish(generation, m_terrain.takeShape())) break;
+        }
+    }
+}
+
+// Hands `mesh` and `heightfield`, where not null, over to takeMesh() and takeHeightfield(),
+// unless they have gone stale
+bool MeshWorker::publish(uint64_t generation, MeshPtr mesh, HeightfieldPtr heightfield)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_latest != generation) return false;
+        if (mesh) m_mesh = std::move(mesh);
+        if (heightfield) m_heightfield = std::move(heightfield);
+    }
+    m_meshReady();
+    return true;
+}
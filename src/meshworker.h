@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Settings.h"
+#include "shapes/Icosphere.h"
+#include "shapes/Mesh.h"
+#include "shapes/Terrain.h"
+
+// Regenerates the terrain (or the icosphere) on a background thread, working from a snapshot of the Settings.
+// Only the newest request matters: requesting again cancels whatever is still in flight,
+// and a finished mesh is only published if nothing newer has been requested since.
+//
+// Each request is refined progressively: a coarse mesh is published first and replaced by
+// finer ones as they finish, so the viewer has something to show within a few milliseconds.
+// The icosphere keeps every subdivision level it has built, so it is published once, usually
+// straight from that cache. In RENDER_HEIGHTMAP mode only the terrain's heightfield is sampled and
+// published, refined the same way; the GPU displaces a shared grid with it.
+class MeshWorker
+{
+public:
+    // Fractions of the full resolution published in turn, ending at full resolution
+    static constexpr int kRefinementDivisors[] = {8, 4, 2, 1};
+
+    // `meshReady` is called on the worker thread whenever a new mesh can be taken
+    explicit MeshWorker(std::function<void()> meshReady);
+    ~MeshWorker();
+
+    void request(const Settings &snapshot);
+
+    // The newest finished mesh, or null if there is none since the last call
+    MeshPtr takeMesh();
+    // Likewise for the heightfield
+    HeightfieldPtr takeHeightfield();
+
+private:
+    void run();
+    bool publish(uint64_t generation, MeshPtr mesh, HeightfieldPtr heightfield = nullptr);
+
+    std::function<void()> m_meshReady;
+    Terrain m_terrain; // only touched by the worker thread
+    Icosphere m_icosphere; // likewise
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit = false;
+    bool m_hasRequest = false;
+    Settings m_request;
+    std::atomic<uint64_t> m_latest = 0;
+
+    MeshPtr m_mesh;
+    HeightfieldPtr m_heightfield;
+
+    std::thread m_thread;
+};
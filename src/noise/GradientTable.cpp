@@ -0,0 +1,32 @@
+#include "GradientTable.h"
+
+#include <map>
+#include <mutex>
+
+// Built by the compiler; forSeed() hands it out without allocating
+static constexpr GradientTable defaultTable(GradientTable::kDefaultSeed);
+
+std::shared_ptr<const GradientTable> GradientTable::forSeed(uint32_t seed) {
+    if (seed == kDefaultSeed) {
+        // Aliasing constructor: no ownership, the table lives for the whole program
+        return std::shared_ptr<const GradientTable>(std::shared_ptr<const GradientTable>(), &defaultTable);
+    }
+
+    // Weak references, so a seed's table is freed once the last generator using it lets go
+    static std::mutex mutex;
+    static std::map<uint32_t, std::weak_ptr<const GradientTable>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = cache.find(seed);
+    if (found != cache.end()) {
+        if (std::shared_ptr<const GradientTable> table = found->second.lock()) return table;
+    }
+
+    // Drop the entries of tables already freed, so seeds that come and go do not grow the map
+    std::erase_if(cache, [](const auto &entry) { return entry.second.expired(); });
+
+    // Not make_shared: its single allocation would keep the table alive as long as the weak reference
+    std::shared_ptr<const GradientTable> table(new GradientTable(seed));
+    cache[seed] = table;
+    return table;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <glm/glm.hpp>
+
+// The random gradient lattice behind all of the terrain's Perlin noise, for one seed.
+//
+// Immutable once built, so a single table is shared read-only by any number of generators and
+// threads (see forSeed()). It is small enough to stay in L1: 256 gradients, structure-of-arrays,
+// and a 512-entry permutation (256 entries repeated, so two chained lookups never need a wrap).
+// Entries come from a counter-based hash of (seed, index) rather than a stateful RNG, so a table
+// depends on nothing but its seed and the default one is built entirely at compile time.
+class GradientTable
+{
+public:
+    static constexpr int kSize = 256;
+    static constexpr int kMask = kSize - 1;
+    static constexpr uint32_t kDefaultSeed = 1230;
+
+    constexpr explicit GradientTable(uint32_t seed) : m_seed(seed) {
+        // Gradients uniform in [-1, 1)^2, like the original rand()-based table
+        for (int i = 0; i < kSize; i++) {
+            m_gradX[i] = toSigned(random(seed, 2 * i));
+            m_gradY[i] = toSigned(random(seed, 2 * i + 1));
+        }
+
+        // Fisher-Yates shuffle of 0..255, continuing the counter past the gradients
+        for (int i = 0; i < kSize; i++) m_perm[i] = i;
+        for (int i = kSize - 1; i > 0; i--) {
+            int j = int(random(seed, 2 * kSize + i) % uint32_t(i + 1));
+            int t = m_perm[i];
+            m_perm[i] = m_perm[j];
+            m_perm[j] = t;
+        }
+        for (int i = 0; i < kSize; i++) m_perm[kSize + i] = m_perm[i];
+    }
+
+    // Shared table for `seed`, built on first use and kept while anyone holds it. Thread-safe.
+    static std::shared_ptr<const GradientTable> forSeed(uint32_t seed);
+
+    uint32_t seed() const { return m_seed; }
+
+    // Index of the gradient at lattice point (x, y); the lattice repeats every kSize cells
+    int index(int x, int y) const { return m_perm[m_perm[x & kMask] + (y & kMask)]; }
+    glm::vec2 gradient(int x, int y) const {
+        int i = index(x, y);
+        return {m_gradX[i], m_gradY[i]};
+    }
+
+    // Raw arrays for the noise kernels
+    const float *gradX() const { return m_gradX.data(); }
+    const float *gradY() const { return m_gradY.data(); }
+    const int *perm() const { return m_perm.data(); }
+
+private:
+    // Counter-based generator: the value for `counter` is a hash, independent of every other draw
+    static constexpr uint32_t mix(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+    static constexpr uint32_t random(uint32_t seed, int counter) {
+        return mix(mix(seed) + uint32_t(counter) * 0x9e3779b9u);
+    }
+    // Top 24 bits, so the conversion to float is exact
+    static constexpr float toSigned(uint32_t r) {
+        return float(r >> 8) * (2.f / 16777216.f) - 1.f;
+    }
+
+    uint32_t m_seed;
+    std::array<float, kSize> m_gradX = {};
+    std::array<float, kSize> m_gradY = {};
+    std::array<int, 2 * kSize> m_perm = {};
+};
@@ -0,0 +1,62 @@
+#include "Perlin3D.h"
+
+#include <cmath>
+
+#include "noise/PerlinKernels.h"
+
+// Perlin's improved-noise gradients: the 12 cube edge directions, 4 of them twice to make 16
+static const double kGradients[16][3] = {
+    {1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0},
+    {1, 0, 1}, {-1, 0, 1}, {1, 0, -1}, {-1, 0, -1},
+    {0, 1, 1}, {0, -1, 1}, {0, 1, -1}, {0, -1, -1},
+    {1, 1, 0}, {-1, 1, 0}, {0, -1, 1}, {0, -1, -1},
+};
+
+Perlin3D::Perlin3D() : m_table(GradientTable::forSeed(GradientTable::kDefaultSeed)) {}
+
+static double ease(double a) {
+    return a * a * (3 - 2 * a);
+}
+
+static double lerp(double a, double b, double t) {
+    return a + t * (b - a);
+}
+
+double Perlin3D::noise(const glm::dvec3 &p) const {
+    glm::dvec3 floored = glm::floor(p);
+    glm::dvec3 f = p - floored;
+    // Wrapped to the table first, so huge coordinates cannot overflow the conversion
+    int X = int(std::fmod(floored.x, 256.0) + 256) & GradientTable::kMask;
+    int Y = int(std::fmod(floored.y, 256.0) + 256) & GradientTable::kMask;
+    int Z = int(std::fmod(floored.z, 256.0) + 256) & GradientTable::kMask;
+
+    const int *perm = m_table->perm();
+    auto corner = [&](int dx, int dy, int dz) {
+        int hash = perm[perm[perm[X + dx] + Y + dy] + Z + dz] & 15;
+        const double *g = kGradients[hash];
+        return g[0] * (f.x - dx) + g[1] * (f.y - dy) + g[2] * (f.z - dz);
+    };
+
+    double u = ease(f.x), v = ease(f.y), w = ease(f.z);
+    double x00 = lerp(corner(0, 0, 0), corner(1, 0, 0), u);
+    double x10 = lerp(corner(0, 1, 0), corner(1, 1, 0), u);
+    double x01 = lerp(corner(0, 0, 1), corner(1, 0, 1), u);
+    double x11 = lerp(corner(0, 1, 1), corner(1, 1, 1), u);
+    return lerp(lerp(x00, x10, v), lerp(x01, x11, v), w);
+}
+
+double Perlin3D::fbm(const glm::dvec3 &p, int octaves) const {
+    double sum = 0, frequency = DefaultFbm::baseFrequency, amplitude = DefaultFbm::baseAmplitude;
+    for (int o = 0; o < octaves; o++) {
+        sum += amplitude * noise(p * frequency);
+        frequency *= DefaultFbm::lacunarity;
+        amplitude *= DefaultFbm::gain;
+    }
+    return sum;
+}
+
+double Perlin3D::fbmBound(int octaves) {
+    double amplitudes = 0, amplitude = DefaultFbm::baseAmplitude;
+    for (int o = 0; o < octaves; o++, amplitude *= DefaultFbm::gain) amplitudes += amplitude;
+    return kBound * amplitudes;
+}
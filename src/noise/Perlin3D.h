@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "noise/GradientTable.h"
+
+// Scalar 3D gradient noise, for surfaces that are not a plane (the cube-sphere planet).
+//
+// Lattice hashing uses a GradientTable's permutation, chained over three axes; the gradients are the
+// 12 cube edge directions of Perlin's improved noise, and the fade is the same 3a^2 - 2a^3 as the 2D
+// noise. Coordinates are doubles: planet octaves reach frequencies where a float lattice coordinate
+// would no longer resolve a vertex spacing.
+class Perlin3D
+{
+public:
+    // No octave sum exceeds this times the sum of the octaves' amplitudes in magnitude
+    static constexpr double kBound = 1.1;
+    // Nor does the gradient of one octave at frequency 1 exceed this (2.85 measured)
+    static constexpr double kGradientBound = 3.5;
+
+    Perlin3D();
+
+    // Same sharing rules as PerlinBatch::setTable()
+    void setTable(std::shared_ptr<const GradientTable> table) { m_table = std::move(table); }
+    const GradientTable &table() const { return *m_table; }
+
+    // One octave at frequency 1, roughly in [-1, 1]
+    double noise(const glm::dvec3 &p) const;
+
+    // `octaves` octaves of DefaultFbm noise
+    double fbm(const glm::dvec3 &p, int octaves) const;
+
+    // Bound on |fbm(p, octaves)|
+    static double fbmBound(int octaves);
+
+private:
+    std::shared_ptr<const GradientTable> m_table;
+};
@@ -0,0 +1,51 @@
+// AVX2 Perlin kernel, 8 samples per pass with hardware gathers.
+// This file alone is built with AVX2 code generation (see CMakeLists.txt), and is only
+// called after PerlinBatch has checked the CPU at runtime. Keep it free of std:: and glm
+// headers: an inline function instantiated here could be picked by the linker for callers
+// running on CPUs without AVX2.
+#define GLM_FORCE_INTRINSICS
+#include "glm/simd/platform.h"
+
+#include "noise/PerlinKernels.h"
+
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+
+namespace {
+
+struct Ops {
+    static constexpr int Width = 8;
+    using Float = __m256;
+    using Int = __m256i;
+
+    static Float load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, Float v) { _mm256_storeu_ps(p, v); }
+    static Float set1(float f) { return _mm256_set1_ps(f); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+
+    static Int floorToInt(Float x, Float &floored) {
+        floored = _mm256_floor_ps(x);
+        return _mm256_cvttps_epi32(floored);
+    }
+
+    static Int iset1(int i) { return _mm256_set1_epi32(i); }
+    static Int iadd(Int a, Int b) { return _mm256_add_epi32(a, b); }
+    static Int iand(Int a, Int b) { return _mm256_and_si256(a, b); }
+
+    static Int igather(const int *table, Int idx) { return _mm256_i32gather_epi32(table, idx, 4); }
+
+    static Float gather(const float *table, Int idx) { return _mm256_i32gather_ps(table, idx, 4); }
+};
+
+} // namespace
+
+#include "noise/PerlinSimd.inl"
+
+const PerlinKernelSet *perlinKernelsAvx2() { return &kernelSet; }
+
+#else
+
+const PerlinKernelSet *perlinKernelsAvx2() { return nullptr; }
+
+#endif
@@ -0,0 +1,127 @@
+#include "PerlinBatch.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// ====================================== CPU DETECTION ====================================== //
+
+static bool cpuHasAvx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // AVX needs OS support for saving the ymm registers
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+static const PerlinKernelSet *kernelSet(PerlinBatch::Kernel kernel) {
+    switch (kernel) {
+    case PerlinBatch::Kernel::AVX2: return perlinKernelsAvx2();
+    case PerlinBatch::Kernel::SSE2: return perlinKernelsSse2();
+    case PerlinBatch::Kernel::Scalar: return perlinKernelsScalar();
+    }
+    return perlinKernelsScalar();
+}
+
+PerlinBatch::Kernel PerlinBatch::bestKernel() {
+    static const Kernel best = [] {
+        if (perlinKernelsAvx2() != nullptr && cpuHasAvx2()) return Kernel::AVX2;
+        if (perlinKernelsSse2() != nullptr) return Kernel::SSE2;
+        return Kernel::Scalar;
+    }();
+    return best;
+}
+
+const char *PerlinBatch::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::AVX2: return "avx2";
+    case Kernel::SSE2: return "sse2";
+    case Kernel::Scalar: return "scalar";
+    }
+    return "scalar";
+}
+
+// ====================================== BATCH API ====================================== //
+
+PerlinBatch::PerlinBatch()
+    : m_table(GradientTable::forSeed(GradientTable::kDefaultSeed)),
+      m_kernel(bestKernel()), m_kernels(kernelSet(m_kernel)) {
+    setOctaves(m_octaveCount);
+}
+
+void PerlinBatch::setKernel(Kernel kernel) {
+    if (kernel > bestKernel()) kernel = bestKernel();
+    while (kernelSet(kernel) == nullptr) {
+        kernel = Kernel(int(kernel) - 1);
+    }
+    m_kernel = kernel;
+    m_kernels = kernelSet(kernel);
+}
+
+void PerlinBatch::setOctaves(int octaves) {
+    m_octaveCount = std::max(1, octaves);
+    m_octaves.resize(m_octaveCount);
+    for (int o = 0; o < m_octaveCount; o++) {
+        m_octaves[o] = {fbmFrequency<DefaultFbm>(o), fbmAmplitude<DefaultFbm>(o)};
+    }
+}
+
+PerlinKernelFn PerlinBatch::heightKernel() const {
+    // Counts with a specialised instantiation skip the runtime octave loop entirely
+    if (m_octaveCount <= kMaxFixedOctaves) return m_kernels->fbm[m_octaveCount - 1];
+    return m_kernels->generic;
+}
+
+void PerlinBatch::evaluate(PerlinKernelFn kernel, const float *x, const float *y,
+                           float *out, float *outDx, float *outDy, int count) const {
+    if (count <= 0) return;
+
+    PerlinKernelArgs args;
+    args.gradX = m_table->gradX();
+    args.gradY = m_table->gradY();
+    args.perm = m_table->perm();
+    args.x = x;
+    args.y = y;
+    args.out = out;
+    args.outDx = outDx;
+    args.outDy = outDy;
+    args.count = count;
+    args.octaves = m_octaves.data();
+    args.octaveCount = m_octaveCount;
+    kernel(args);
+}
+
+void PerlinBatch::computePerlin(const float *x, const float *y, float *out, int count) const {
+    evaluate(m_kernels->unit, x, y, out, nullptr, nullptr, count);
+}
+
+void PerlinBatch::getHeight(const float *x, const float *y, float *out, int count) const {
+    evaluate(heightKernel(), x, y, out, nullptr, nullptr, count);
+}
+
+void PerlinBatch::getHeightAndGradient(const float *x, const float *y, float *out,
+                                       float *outDx, float *outDy, int count) const {
+    evaluate(heightKernel(), x, y, out, outDx, outDy, count);
+}
+
+void PerlinBatch::getHeightRow(const float *x, float y, float *out,
+                               float *outDx, float *outDy, int count) const {
+    evaluate(m_kernels->scanline, x, &y, out, outDx, outDy, count);
+}
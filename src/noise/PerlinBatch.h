@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "noise/GradientTable.h"
+#include "noise/PerlinKernels.h"
+
+// Evaluates the terrain's gradient noise for many samples at once.
+//
+// This is the batched counterpart of Terrain::computePerlin() / Terrain::getHeight().
+// The widest kernel the CPU supports (AVX2, SSE2 or plain scalar) is picked at runtime,
+// and all kernels agree with the scalar Terrain path to within kTolerance (checked by the
+// noise.kernels test).
+class PerlinBatch
+{
+public:
+    enum class Kernel { Scalar, SSE2, AVX2 };
+
+    // Largest absolute difference from Terrain::getHeight() for any sample.
+    // The scalar path eases through pow() in double precision, the kernels stay in float.
+    static constexpr float kTolerance = 1e-5f;
+
+    PerlinBatch();
+
+    // Gradient lattice to sample; GradientTable::forSeed(GradientTable::kDefaultSeed) unless changed.
+    // Shared, not copied: any number of evaluators can read the same table concurrently.
+    void setTable(std::shared_ptr<const GradientTable> table) { m_table = std::move(table); }
+    const GradientTable &table() const { return *m_table; }
+
+    // out[i] = Terrain::computePerlin(x[i], y[i])
+    void computePerlin(const float *x, const float *y, float *out, int count) const;
+
+    // out[i] = Terrain::getHeight(x[i], y[i]), i.e. octaves() octaves of fractal noise
+    void getHeight(const float *x, const float *y, float *out, int count) const;
+
+    // getHeight() plus its analytic partial derivatives d/dx and d/dy, summed over the octaves
+    // in the same pass. Needs no neighbouring samples, so normals cost almost nothing extra.
+    void getHeightAndGradient(const float *x, const float *y, float *out,
+                              float *outDx, float *outDy, int count) const;
+
+    // getHeightAndGradient() along one row of constant y, for grids. `x` must be non-decreasing:
+    // each octave is walked cell by cell, fetching a cell's gradients once and sharing the
+    // per-cell terms between all the samples that fall inside it. outDx / outDy may both be null.
+    // Agrees with getHeightAndGradient() to within kTolerance, not bit for bit.
+    void getHeightRow(const float *x, float y, float *out, float *outDx, float *outDy, int count) const;
+
+    // Number of DefaultFbm octaves summed by getHeight(), 4 unless changed.
+    // Up to kMaxFixedOctaves this selects a kernel compiled for exactly that many octaves.
+    int octaves() const { return m_octaveCount; }
+    void setOctaves(int octaves);
+
+    Kernel kernel() const { return m_kernel; }
+    // Forces a specific kernel (for comparisons); falls back to the best supported one below it
+    void setKernel(Kernel kernel);
+
+    static Kernel bestKernel();
+    static const char *kernelName(Kernel kernel);
+
+private:
+    PerlinKernelFn heightKernel() const;
+    void evaluate(PerlinKernelFn kernel, const float *x, const float *y,
+                  float *out, float *outDx, float *outDy, int count) const;
+
+    std::shared_ptr<const GradientTable> m_table;
+    Kernel m_kernel;
+    const PerlinKernelSet *m_kernels;
+    int m_octaveCount = 4;
+    std::vector<PerlinOctave> m_octaves; // for the generic kernel, above kMaxFixedOctaves
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+// Plain-C interface between PerlinBatch and its per-instruction-set kernels.
+// The kernel translation units are compiled with different target flags, so nothing
+// that could be inlined into ordinary code (std:: templates, glm types) crosses this boundary.
+
+struct PerlinOctave {
+    float frequency;
+    float amplitude;
+};
+
+struct PerlinKernelArgs {
+    const float *gradX;   // GradientTable's 256 gradients, structure-of-arrays
+    const float *gradY;
+    const int *perm;      // and its 512-entry permutation
+
+    const float *x;
+    const float *y;
+    float *out;
+    float *outDx;         // optional partial derivatives of out, d/dx and d/dy; both or neither
+    float *outDy;
+    int count;
+
+    const PerlinOctave *octaves; // only read by the generic and scanline kernels
+    int octaveCount;
+};
+
+using PerlinKernelFn = void (*)(const PerlinKernelArgs &args);
+
+// Compile-time fractal parameters. Octave o has frequency baseFrequency * lacunarity^o and
+// amplitude baseAmplitude * gain^o; the defaults are Terrain::getHeight()'s octaves (x8, x16, x32, ...)
+struct DefaultFbm {
+    static constexpr float baseFrequency = 8.f;
+    static constexpr float baseAmplitude = 1.f / 8.f;
+    static constexpr float lacunarity = 2.f;
+    static constexpr float gain = 0.5f;
+};
+
+// A single octave at frequency 1: plain Terrain::computePerlin()
+struct UnitNoise {
+    static constexpr float baseFrequency = 1.f;
+    static constexpr float baseAmplitude = 1.f;
+    static constexpr float lacunarity = 1.f;
+    static constexpr float gain = 1.f;
+};
+
+// Frequency and amplitude of an octave. The fixed-octave kernels fold them into constants; the scalar
+// Terrain path, the generic kernel's octave table and the height bounds call them at runtime.
+template <class Params>
+constexpr float fbmFrequency(int octave) {
+    float f = Params::baseFrequency;
+    for (int o = 0; o < octave; o++) f *= Params::lacunarity;
+    return f;
+}
+
+template <class Params>
+constexpr float fbmAmplitude(int octave) {
+    float a = Params::baseAmplitude;
+    for (int o = 0; o < octave; o++) a *= Params::gain;
+    return a;
+}
+
+// No sum of `octaves` octaves exceeds this in magnitude. With gradients in [-1, 1]^2 each corner's term
+// is at most |dx| + |dy|, and the eased blend of the four peaks at exactly 1 in the cell's middle, so
+// every octave is bounded by its amplitude.
+template <class Params>
+constexpr float fbmBound(int octaves) {
+    float bound = 0.f;
+    for (int o = 0; o < octaves; o++) bound += fbmAmplitude<Params>(o);
+    return bound;
+}
+
+// Octave counts with a compile-time specialised kernel; others take the generic one
+constexpr int kMaxFixedOctaves = 8;
+
+struct PerlinKernelSet {
+    PerlinKernelFn generic;                 // octaves read from PerlinKernelArgs
+    PerlinKernelFn unit;                    // UnitNoise
+    PerlinKernelFn scanline;                // generic octaves along one row: y[0] only, x non-decreasing
+    PerlinKernelFn fbm[kMaxFixedOctaves];   // fbm[n - 1]: n octaves of DefaultFbm
+};
+
+const PerlinKernelSet *perlinKernelsScalar();
+// These return nullptr when the kernel was not compiled for this target
+const PerlinKernelSet *perlinKernelsSse2();
+const PerlinKernelSet *perlinKernelsAvx2();
@@ -0,0 +1,40 @@
+// Portable Perlin kernel, one sample per pass.
+// Runs the same templated body as the SIMD kernels with one-lane "vectors", so every
+// kernel performs the same float operations in the same order and produces identical results.
+#include <cmath>
+
+#include "noise/PerlinKernels.h"
+
+namespace {
+
+struct Ops {
+    static constexpr int Width = 1;
+    using Float = float;
+    using Int = unsigned; // unsigned, so large lattice coordinates wrap instead of overflowing
+
+    static Float load(const float *p) { return *p; }
+    static void store(float *p, Float v) { *p = v; }
+    static Float set1(float f) { return f; }
+    static Float add(Float a, Float b) { return a + b; }
+    static Float sub(Float a, Float b) { return a - b; }
+    static Float mul(Float a, Float b) { return a * b; }
+
+    static Int floorToInt(Float x, Float &floored) {
+        floored = std::floor(x);
+        return Int(int(floored));
+    }
+
+    static Int iset1(int i) { return Int(i); }
+    static Int iadd(Int a, Int b) { return a + b; }
+    static Int iand(Int a, Int b) { return a & b; }
+
+    static Int igather(const int *table, Int idx) { return Int(table[idx]); }
+
+    static Float gather(const float *table, Int idx) { return table[idx]; }
+};
+
+} // namespace
+
+#include "noise/PerlinSimd.inl"
+
+const PerlinKernelSet *perlinKernelsScalar() { return &kernelSet; }
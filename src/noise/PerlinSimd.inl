@@ -0,0 +1,369 @@
+// Shared body of the scalar, SSE2 and AVX2 Perlin kernels.
+// Included by PerlinScalar.cpp / PerlinSse2.cpp / PerlinAvx2.cpp after they define an `Ops` type with:
+//   Width, Float, Int, load, store, set1, add, sub, mul, floorToInt,
+//   iset1, iadd, iand, igather, gather
+// Everything here lives in an anonymous namespace so the instantiations can never be merged,
+// and each file exports only the resulting `kernelSet`.
+
+namespace {
+
+// 3a^2 - 2a^3, same curve as Terrain::interpolate()
+inline Ops::Float ease(Ops::Float a) {
+    return Ops::mul(Ops::mul(a, a), Ops::sub(Ops::set1(3.f), Ops::add(a, a)));
+}
+
+// Derivative of ease(): 6a - 6a^2
+inline Ops::Float easeSlope(Ops::Float a) {
+    return Ops::mul(Ops::mul(Ops::set1(6.f), a), Ops::sub(Ops::set1(1.f), a));
+}
+
+inline Ops::Float lerp(Ops::Float a, Ops::Float b, Ops::Float t) {
+    return Ops::add(a, Ops::mul(t, Ops::sub(b, a)));
+}
+
+// One octave of Perlin noise for Ops::Width samples.
+// With WithGradient, also writes the analytic partial derivatives d/dx and d/dy.
+template <bool WithGradient>
+inline Ops::Float perlin(const PerlinKernelArgs &args, Ops::Float x, Ops::Float y,
+                         Ops::Float &dx, Ops::Float &dy) {
+    Ops::Float fx, fy;
+    Ops::Int X = Ops::floorToInt(x, fx);
+    Ops::Int Y = Ops::floorToInt(y, fy);
+
+    // Offsets from the bottom-left lattice point
+    Ops::Float u = Ops::sub(x, fx);
+    Ops::Float v = Ops::sub(y, fy);
+    Ops::Float one = Ops::set1(1.f);
+    Ops::Float u1 = Ops::sub(u, one);
+    Ops::Float v1 = Ops::sub(v, one);
+
+    // Same lookup as GradientTable::index(): perm[perm[x & 255] + (y & 255)]
+    Ops::Int mask = Ops::iset1(255);
+    Ops::Int one1 = Ops::iset1(1);
+    Ops::Int px0 = Ops::igather(args.perm, Ops::iand(X, mask));
+    Ops::Int px1 = Ops::igather(args.perm, Ops::iand(Ops::iadd(X, one1), mask));
+    Ops::Int y0 = Ops::iand(Y, mask);
+    Ops::Int y1 = Ops::iand(Ops::iadd(Y, one1), mask);
+    Ops::Int i1 = Ops::igather(args.perm, Ops::iadd(px0, y0));
+    Ops::Int i2 = Ops::igather(args.perm, Ops::iadd(px1, y0));
+    Ops::Int i3 = Ops::igather(args.perm, Ops::iadd(px0, y1));
+    Ops::Int i4 = Ops::igather(args.perm, Ops::iadd(px1, y1));
+
+    Ops::Float g1x = Ops::gather(args.gradX, i1), g1y = Ops::gather(args.gradY, i1);
+    Ops::Float g2x = Ops::gather(args.gradX, i2), g2y = Ops::gather(args.gradY, i2);
+    Ops::Float g3x = Ops::gather(args.gradX, i3), g3y = Ops::gather(args.gradY, i3);
+    Ops::Float g4x = Ops::gather(args.gradX, i4), g4y = Ops::gather(args.gradY, i4);
+
+    Ops::Float dot1 = Ops::add(Ops::mul(u,  g1x), Ops::mul(v,  g1y));
+    Ops::Float dot2 = Ops::add(Ops::mul(u1, g2x), Ops::mul(v,  g2y));
+    Ops::Float dot3 = Ops::add(Ops::mul(u,  g3x), Ops::mul(v1, g3y));
+    Ops::Float dot4 = Ops::add(Ops::mul(u1, g4x), Ops::mul(v1, g4y));
+
+    Ops::Float eu = ease(u);
+    Ops::Float ev = ease(v);
+    Ops::Float inter1 = lerp(dot1, dot2, eu);
+    Ops::Float inter2 = lerp(dot3, dot4, eu);
+
+    if (WithGradient) {
+        // Product rule through both lerps; the dot products are linear in u and v
+        Ops::Float du1 = Ops::add(lerp(g1x, g2x, eu), Ops::mul(easeSlope(u), Ops::sub(dot2, dot1)));
+        Ops::Float du2 = Ops::add(lerp(g3x, g4x, eu), Ops::mul(easeSlope(u), Ops::sub(dot4, dot3)));
+        Ops::Float dv1 = lerp(g1y, g2y, eu);
+        Ops::Float dv2 = lerp(g3y, g4y, eu);
+        dx = lerp(du1, du2, ev);
+        dy = Ops::add(lerp(dv1, dv2, ev), Ops::mul(easeSlope(v), Ops::sub(inter2, inter1)));
+    }
+    return lerp(inter1, inter2, ev);
+}
+
+// Adds one octave, a * noise(f * p), and its derivatives a * f * noise'(f * p)
+template <bool WithGradient>
+inline void accumulateOctave(const PerlinKernelArgs &args, Ops::Float x, Ops::Float y,
+                             Ops::Float f, Ops::Float a,
+                             Ops::Float &z, Ops::Float &dx, Ops::Float &dy) {
+    Ops::Float ndx, ndy;
+    Ops::Float n = perlin<WithGradient>(args, Ops::mul(x, f), Ops::mul(y, f), ndx, ndy);
+    z = Ops::add(z, Ops::mul(n, a));
+    if (WithGradient) {
+        Ops::Float af = Ops::mul(a, f);
+        dx = Ops::add(dx, Ops::mul(ndx, af));
+        dy = Ops::add(dy, Ops::mul(ndy, af));
+    }
+}
+
+// Octaves listed in the kernel arguments at runtime
+struct RuntimeOctaves {
+    template <bool WithGradient>
+    static Ops::Float eval(const PerlinKernelArgs &args, Ops::Float x, Ops::Float y,
+                           Ops::Float &dx, Ops::Float &dy) {
+        Ops::Float z = Ops::set1(0.f);
+        dx = z;
+        dy = z;
+        for (int o = 0; o < args.octaveCount; o++) {
+            accumulateOctave<WithGradient>(args, x, y, Ops::set1(args.octaves[o].frequency),
+                                           Ops::set1(args.octaves[o].amplitude), z, dx, dy);
+        }
+        return z;
+    }
+};
+
+// Octave count, lacunarity and gain fixed at compile time: the octave loop is unrolled
+// by recursion and every frequency and amplitude folds to a constant
+template <int Octaves, class Params>
+struct FixedOctaves {
+    template <bool WithGradient, int O = 0>
+    static void accumulate(const PerlinKernelArgs &args, Ops::Float x, Ops::Float y,
+                           Ops::Float &z, Ops::Float &dx, Ops::Float &dy) {
+        if constexpr (O < Octaves) {
+            constexpr float f = fbmFrequency<Params>(O);
+            constexpr float a = fbmAmplitude<Params>(O);
+            accumulateOctave<WithGradient>(args, x, y, Ops::set1(f), Ops::set1(a), z, dx, dy);
+            accumulate<WithGradient, O + 1>(args, x, y, z, dx, dy);
+        }
+    }
+
+    template <bool WithGradient>
+    static Ops::Float eval(const PerlinKernelArgs &args, Ops::Float x, Ops::Float y,
+                           Ops::Float &dx, Ops::Float &dy) {
+        Ops::Float z = Ops::set1(0.f);
+        dx = z;
+        dy = z;
+        accumulate<WithGradient>(args, x, y, z, dx, dy);
+        return z;
+    }
+};
+
+template <bool WithGradient, class Fractal>
+void runLanes(const PerlinKernelArgs &args) {
+    Ops::Float dx, dy;
+    int i = 0;
+    for (; i + Ops::Width <= args.count; i += Ops::Width) {
+        Ops::store(args.out + i, Fractal::template eval<WithGradient>(args, Ops::load(args.x + i), Ops::load(args.y + i), dx, dy));
+        if (WithGradient) {
+            Ops::store(args.outDx + i, dx);
+            Ops::store(args.outDy + i, dy);
+        }
+    }
+
+    // Pad the tail into one more full-width pass
+    if (i < args.count) {
+        alignas(32) float x[Ops::Width] = {};
+        alignas(32) float y[Ops::Width] = {};
+        alignas(32) float z[Ops::Width];
+        alignas(32) float zx[Ops::Width];
+        alignas(32) float zy[Ops::Width];
+        int rest = args.count - i;
+        for (int k = 0; k < rest; k++) {
+            x[k] = args.x[i + k];
+            y[k] = args.y[i + k];
+        }
+        Ops::store(z, Fractal::template eval<WithGradient>(args, Ops::load(x), Ops::load(y), dx, dy));
+        Ops::store(zx, dx);
+        Ops::store(zy, dy);
+        for (int k = 0; k < rest; k++) {
+            args.out[i + k] = z[k];
+            if (WithGradient) {
+                args.outDx[i + k] = zx[k];
+                args.outDy[i + k] = zy[k];
+            }
+        }
+    }
+}
+
+template <class Fractal>
+void runKernel(const PerlinKernelArgs &args) {
+    if (args.outDx != nullptr) {
+        runLanes<true, Fractal>(args);
+    } else {
+        runLanes<false, Fractal>(args);
+    }
+}
+
+// ---- Scanline evaluation: one row of constant y, x non-decreasing ----
+
+inline float floorScalar(float x) {
+    float t = float(int(x));
+    return t > x ? t - 1.f : t;
+}
+
+// Within one lattice cell, on a row of constant v, one octave of noise reduces to
+//   n(u) = P(u) + ease(u) * Q(u)
+//   dn/du = P' + easeSlope(u) * Q(u) + ease(u) * Q'
+//   dn/dv = R(u) + ease(u) * S(u)
+// with P, Q, R and S linear in u (c0 + c1 * u). They only depend on the cell's four gradients
+// and v, so they are set up once per cell and shared by every sample inside it.
+struct CellTerms {
+    Ops::Float p0, p1, q0, q1, r0, r1, s0, s1;
+
+    void set(const PerlinKernelArgs &args, int cellX, int cellY, float v, float ev, float sv) {
+        const int *perm = args.perm;
+        int px0 = perm[cellX & 255], px1 = perm[(cellX + 1) & 255];
+        int y0 = cellY & 255, y1 = (cellY + 1) & 255;
+        int i1 = perm[px0 + y0];
+        int i2 = perm[px1 + y0];
+        int i3 = perm[px0 + y1];
+        int i4 = perm[px1 + y1];
+        float g1x = args.gradX[i1], g1y = args.gradY[i1];
+        float g2x = args.gradX[i2], g2y = args.gradY[i2];
+        float g3x = args.gradX[i3], g3y = args.gradY[i3];
+        float g4x = args.gradX[i4], g4y = args.gradY[i4];
+
+        // The corner dot products are c0 + c1 * u; the bottom and top edges' differences likewise
+        float dot1c0 = v * g1y,               dot1c1 = g1x;
+        float dot2c0 = v * g2y - g2x,         dot2c1 = g2x;
+        float dot3c0 = (v - 1.f) * g3y,       dot3c1 = g3x;
+        float dot4c0 = (v - 1.f) * g4y - g4x, dot4c1 = g4x;
+        float bottomC0 = dot2c0 - dot1c0, bottomC1 = dot2c1 - dot1c1;
+        float topC0 = dot4c0 - dot3c0, topC1 = dot4c1 - dot3c1;
+        float bottomDv = g2y - g1y, topDv = g4y - g3y;
+
+        p0 = Ops::set1(dot1c0 + ev * (dot3c0 - dot1c0));
+        p1 = Ops::set1(dot1c1 + ev * (dot3c1 - dot1c1));
+        q0 = Ops::set1(bottomC0 + ev * (topC0 - bottomC0));
+        q1 = Ops::set1(bottomC1 + ev * (topC1 - bottomC1));
+        r0 = Ops::set1(g1y + ev * (g3y - g1y) + sv * (dot3c0 - dot1c0));
+        r1 = Ops::set1(sv * (dot3c1 - dot1c1));
+        s0 = Ops::set1(bottomDv + ev * (topDv - bottomDv) + sv * (topC0 - bottomC0));
+        s1 = Ops::set1(sv * (topC1 - bottomC1));
+    }
+};
+
+// One octave of a row. Ops::Width consecutive samples that share a cell are evaluated from the
+// cell's terms, fetched once when the cell is entered; samples straddling cells (most of them,
+// once cells get narrower than Ops::Width) fall back to the per-lane gathers of perlin().
+class RowOctave {
+public:
+    RowOctave(const PerlinKernelArgs &args, const PerlinOctave &octave, float y)
+        : m_args(args), m_f(octave.frequency), m_frequency(Ops::set1(octave.frequency)),
+          m_amplitude(Ops::set1(octave.amplitude)),
+          m_slopeAmplitude(Ops::set1(octave.amplitude * octave.frequency)),
+          m_y(Ops::set1(y * octave.frequency)) {
+        float fy = floorScalar(y * m_f);
+        m_v = y * m_f - fy;
+        m_cellY = int(fy);
+    }
+
+    template <bool WithGradient>
+    void accumulate(const float *x, float *out, float *outDx, float *outDy) {
+        Ops::Float xf = Ops::mul(Ops::load(x), m_frequency);
+        float first = floorScalar(x[0] * m_f);
+        float last = floorScalar(x[Ops::Width - 1] * m_f);
+
+        Ops::Float n, dx, dy;
+        if (first == last) {
+            if (!m_hasCell || first != m_cellX) {
+                float v = m_v;
+                float ev = v * v * (3.f - (v + v));
+                float sv = 6.f * v * (1.f - v);
+                m_cell.set(m_args, int(first), m_cellY, v, ev, sv);
+                m_cellX = first;
+                m_hasCell = true;
+            }
+            const CellTerms &c = m_cell;
+            Ops::Float u = Ops::sub(xf, Ops::set1(first));
+            Ops::Float eu = ease(u);
+            Ops::Float q = Ops::add(c.q0, Ops::mul(c.q1, u));
+            n = Ops::add(Ops::add(c.p0, Ops::mul(c.p1, u)), Ops::mul(eu, q));
+            if (WithGradient) {
+                dx = Ops::add(Ops::add(c.p1, Ops::mul(easeSlope(u), q)), Ops::mul(eu, c.q1));
+                dy = Ops::add(Ops::add(c.r0, Ops::mul(c.r1, u)),
+                              Ops::mul(eu, Ops::add(c.s0, Ops::mul(c.s1, u))));
+            }
+        } else {
+            n = perlin<WithGradient>(m_args, xf, m_y, dx, dy);
+        }
+
+        Ops::store(out, Ops::add(Ops::load(out), Ops::mul(n, m_amplitude)));
+        if (WithGradient) {
+            Ops::store(outDx, Ops::add(Ops::load(outDx), Ops::mul(dx, m_slopeAmplitude)));
+            Ops::store(outDy, Ops::add(Ops::load(outDy), Ops::mul(dy, m_slopeAmplitude)));
+        }
+    }
+
+private:
+    const PerlinKernelArgs &m_args;
+    float m_f;
+    Ops::Float m_frequency, m_amplitude, m_slopeAmplitude, m_y;
+    float m_v;
+    int m_cellY;
+
+    bool m_hasCell = false;
+    float m_cellX = 0.f;
+    CellTerms m_cell = {};
+};
+
+// args.y[0] is the row's y; args.x must be non-decreasing
+template <bool WithGradient>
+void runScanlineLanes(const PerlinKernelArgs &args) {
+    for (int i = 0; i < args.count; i++) {
+        args.out[i] = 0.f;
+        if (WithGradient) {
+            args.outDx[i] = 0.f;
+            args.outDy[i] = 0.f;
+        }
+    }
+
+    for (int o = 0; o < args.octaveCount; o++) {
+        RowOctave row(args, args.octaves[o], args.y[0]);
+        int i = 0;
+        for (; i + Ops::Width <= args.count; i += Ops::Width) {
+            row.accumulate<WithGradient>(args.x + i, args.out + i, WithGradient ? args.outDx + i : nullptr,
+                                         WithGradient ? args.outDy + i : nullptr);
+        }
+
+        // Pad the tail by repeating the last sample, which keeps x non-decreasing
+        if (i < args.count) {
+            alignas(32) float x[Ops::Width];
+            alignas(32) float z[Ops::Width] = {};
+            alignas(32) float zx[Ops::Width] = {};
+            alignas(32) float zy[Ops::Width] = {};
+            int rest = args.count - i;
+            for (int k = 0; k < Ops::Width; k++) {
+                x[k] = args.x[k < rest ? i + k : args.count - 1];
+            }
+            for (int k = 0; k < rest; k++) {
+                z[k] = args.out[i + k];
+                if (WithGradient) {
+                    zx[k] = args.outDx[i + k];
+                    zy[k] = args.outDy[i + k];
+                }
+            }
+            row.accumulate<WithGradient>(x, z, zx, zy);
+            for (int k = 0; k < rest; k++) {
+                args.out[i + k] = z[k];
+                if (WithGradient) {
+                    args.outDx[i + k] = zx[k];
+                    args.outDy[i + k] = zy[k];
+                }
+            }
+        }
+    }
+}
+
+void runScanline(const PerlinKernelArgs &args) {
+    if (args.outDx != nullptr) {
+        runScanlineLanes<true>(args);
+    } else {
+        runScanlineLanes<false>(args);
+    }
+}
+
+// Every variant this instruction set provides
+const PerlinKernelSet kernelSet = {
+    &runKernel<RuntimeOctaves>,
+    &runKernel<FixedOctaves<1, UnitNoise>>,
+    &runScanline,
+    {
+        &runKernel<FixedOctaves<1, DefaultFbm>>,
+        &runKernel<FixedOctaves<2, DefaultFbm>>,
+        &runKernel<FixedOctaves<3, DefaultFbm>>,
+        &runKernel<FixedOctaves<4, DefaultFbm>>,
+        &runKernel<FixedOctaves<5, DefaultFbm>>,
+        &runKernel<FixedOctaves<6, DefaultFbm>>,
+        &runKernel<FixedOctaves<7, DefaultFbm>>,
+        &runKernel<FixedOctaves<8, DefaultFbm>>,
+    }
+};
+static_assert(kMaxFixedOctaves == 8, "kernelSet.fbm lists one instantiation per octave count");
+
+} // namespace
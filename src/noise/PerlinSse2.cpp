@@ -0,0 +1,61 @@
+// SSE2 Perlin kernel, 4 samples per pass.
+// Only glm's platform detection is included here; see PerlinKernels.h for why.
+#define GLM_FORCE_INTRINSICS
+#include "glm/simd/platform.h"
+
+#include "noise/PerlinKernels.h"
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+namespace {
+
+struct Ops {
+    static constexpr int Width = 4;
+    using Float = __m128;
+    using Int = __m128i;
+
+    static Float load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, Float v) { _mm_storeu_ps(p, v); }
+    static Float set1(float f) { return _mm_set1_ps(f); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+
+    // SSE2 has no floor, so truncate and step down where truncation rounded up
+    static Int floorToInt(Float x, Float &floored) {
+        Int t = _mm_cvttps_epi32(x);
+        Float tf = _mm_cvtepi32_ps(t);
+        Int roundedUp = _mm_castps_si128(_mm_cmpgt_ps(tf, x));
+        t = _mm_add_epi32(t, roundedUp); // all-ones lanes are -1
+        floored = _mm_cvtepi32_ps(t);
+        return t;
+    }
+
+    static Int iset1(int i) { return _mm_set1_epi32(i); }
+    static Int iadd(Int a, Int b) { return _mm_add_epi32(a, b); }
+    static Int iand(Int a, Int b) { return _mm_and_si128(a, b); }
+
+    static Int igather(const int *table, Int idx) {
+        alignas(16) int i[4];
+        _mm_store_si128(reinterpret_cast<Int *>(i), idx);
+        return _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+    }
+
+    static Float gather(const float *table, Int idx) {
+        alignas(16) int i[4];
+        _mm_store_si128(reinterpret_cast<Int *>(i), idx);
+        return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+    }
+};
+
+} // namespace
+
+#include "noise/PerlinSimd.inl"
+
+const PerlinKernelSet *perlinKernelsSse2() { return &kernelSet; }
+
+#else
+
+const PerlinKernelSet *perlinKernelsSse2() { return nullptr; }
+
+#endif
@@ -0,0 +1,135 @@
+#include "planetrenderer.h"
+
+#include <QOpenGLShaderProgram>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "vertexattributes.h"
+
+// Largest on-screen size of a quad, in pixels, before a finer level takes over
+static constexpr float kPixelError = 8.f;
+// Vertex slots allocated up front; the pool doubles them whenever one frame needs more
+static constexpr int kInitialSlots = 256;
+
+static const char *planetVertexShaderSource =
+    "#version 330 core\n"
+    "layout(location = 0) in vec3 vertex;\n" // relative to the chunk's center
+    "layout(location = 1) in vec3 normal;\n"
+    "out vec3 vertNormal;\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform mat4 mvMatrix;\n"      // the chunk's: view * translate(center)
+    "uniform mat3 normalMatrix;\n"
+    "void main() {\n"
+    "   vertNormal = normalMatrix * normal;\n"
+    "   gl_Position = projMatrix * mvMatrix * vec4(vertex, 1.0);\n"
+    "}\n";
+
+void PlanetRenderer::create()
+{
+    initializeOpenGLFunctions();
+
+    m_program = new QOpenGLShaderProgram;
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, planetVertexShaderSource);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, glslSource({shadeSource, sunLitFragmentSource}).c_str());
+    m_program->link();
+
+    std::vector<uint16_t> indices = PlanetChunkBuilder::indices(kGridSize);
+    m_indexCount = GLsizei(indices.size());
+
+    m_vao.create();
+    m_vao.bind();
+    glGenBuffers(1, &m_indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indices.size() * sizeof(uint16_t)), indices.data(), GL_STATIC_DRAW);
+    m_pool.create(GLsizeiptr(PlanetChunkBuilder::vertexCount(kGridSize) * MeshVertexFormat::stride), kInitialSlots,
+                  &setVertexAttributes<MeshVertexFormat>);
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PlanetRenderer::destroy()
+{
+    delete m_program;
+    m_program = nullptr;
+    m_pool.destroy();
+    glDeleteBuffers(1, &m_indexBuffer);
+    m_indexBuffer = 0;
+    m_vao.destroy();
+}
+
+void PlanetRenderer::configure(double radius, double heightScale)
+{
+    if (radius == m_radius && heightScale == m_heightScale) return;
+    m_radius = radius;
+    m_heightScale = heightScale;
+
+    m_builder.setRadius(radius);
+    m_builder.setHeightScale(heightScale);
+    m_tree.configure(radius, m_builder.minRadius(), m_builder.maxRadius(), kGridSize, kMaxDepth);
+    m_tree.setRadiusBounds([this](const PlanetNode &node) { return m_builder.radiusBounds(node, kGridSize); });
+    m_pool.clear();
+}
+
+void PlanetRenderer::render(const glm::mat4 &proj, const glm::dmat4 &view, int viewportHeight, bool wireframe)
+{
+    m_pool.beginFrame();
+
+    // One world unit at distance 1 covers this many pixels
+    float pixelsPerUnit = viewportHeight * proj[1][1] / 2;
+    if (pixelsPerUnit != m_pixelsPerUnit) {
+        m_pixelsPerUnit = pixelsPerUnit;
+        m_tree.setView(pixelsPerUnit, kPixelError);
+    }
+    glm::dvec3 camera = glm::dvec3(glm::inverse(view)[3]);
+    m_tree.select(camera, glm::dmat4(proj) * view, m_selection);
+
+    m_vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, m_pool.bufferId());
+
+    // Mark every resident chunk used first, so none of them is evicted for a later one
+    m_slots.resize(m_selection.size());
+    for (size_t i = 0; i < m_selection.size(); i++) m_slots[i] = m_pool.find(m_selection[i].key());
+    for (size_t i = 0; i < m_selection.size(); i++) {
+        if (m_slots[i] >= 0) continue;
+        const PlanetNode &node = m_selection[i];
+        m_slots[i] = m_pool.insert(node.key());
+        m_staging.resize(size_t(PlanetChunkBuilder::vertexCount(kGridSize) * MeshVertexFormat::stride));
+        m_centers.resize(size_t(m_pool.slotCount()));
+        m_centers[size_t(m_slots[i])] = m_builder.build(node, kGridSize, m_staging.data());
+        m_pool.upload(m_slots[i], m_staging.data());
+    }
+
+    // The view's rotation is every chunk's normal matrix: chunks are only translated
+    glm::mat3 rotation = glm::mat3(glm::dmat3(view));
+    m_program->bind();
+    m_program->setUniformValue("projMatrix", toQMatrix(proj));
+    m_program->setUniformValue("normalMatrix", toQMatrix(glm::mat4(rotation)).normalMatrix());
+    glm::vec3 light = glm::normalize(rotation * glm::vec3(1, 1, 1));
+    m_program->setUniformValue("lightDir", QVector3D(light.x, light.y, light.z));
+
+    int passes = wireframe ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        bool lines = pass == 1;
+        m_program->setUniformValue("wireframe", lines);
+        glPolygonMode(GL_FRONT_AND_BACK, lines ? GL_LINE : GL_FILL);
+        if (lines) {
+            glEnable(GL_POLYGON_OFFSET_LINE);
+            glPolygonOffset(-1, -1);
+        }
+        for (size_t i = 0; i < m_selection.size(); i++) {
+            int slot = m_slots[i];
+            // Camera-relative in double; the float matrix only ever holds eye-space offsets
+            glm::dmat4 chunkView = glm::translate(view, m_centers[size_t(slot)]);
+            m_program->setUniformValue("mvMatrix", toQMatrix(glm::mat4(chunkView)));
+            glDrawElementsBaseVertex(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_SHORT, nullptr,
+                                     slot * PlanetChunkBuilder::vertexCount(kGridSize));
+        }
+    }
+    glDisable(GL_POLYGON_OFFSET_LINE);
+    glPolygonOffset(0, 0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    m_program->release();
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
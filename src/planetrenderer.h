@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLVertexArrayObject>
+
+#include "chunkpool.h"
+#include "lod/PlanetChunkBuilder.h"
+#include "lod/PlanetQuadtree.h"
+
+QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
+
+// Draws a cube-sphere planet as chunked LOD (see PlanetQuadtree), centered at the origin.
+//
+// All chunks share one index buffer and live in a ChunkPool. Chunk vertices are relative to their
+// chunk's center; each chunk's model-view matrix is formed in double precision from the view and that
+// center and only then rounded to float, so nothing far from the camera ever reaches the GPU.
+// Needs a current GL context throughout.
+class PlanetRenderer : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    static constexpr int kGridSize = 32;
+    // 1 / (32 * 2^20) of a quarter great circle: about 30 cm quads on an Earth-sized planet
+    static constexpr int kMaxDepth = 20;
+
+    void create();
+    void destroy();
+
+    // Planet of `radius` whose surface is displaced by up to about `heightScale * radius`; any change
+    // drops every cached chunk
+    void configure(double radius, double heightScale);
+    const PlanetQuadtree &quadtree() const { return m_tree; }
+    const PlanetChunkBuilder &builder() const { return m_builder; }
+
+    // `view` maps planet coordinates to the eye
+    void render(const glm::mat4 &proj, const glm::dmat4 &view, int viewportHeight, bool wireframe);
+
+private:
+    PlanetQuadtree m_tree;
+    PlanetChunkBuilder m_builder;
+    double m_radius = 0.0;
+    double m_heightScale = 0.0;
+    float m_pixelsPerUnit = 0.f;
+
+    QOpenGLShaderProgram *m_program = nullptr;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_indexBuffer = 0;
+    GLsizei m_indexCount = 0;
+    ChunkPool m_pool;
+    std::vector<glm::dvec3> m_centers; // chunk centers by slot
+    std::vector<unsigned char> m_staging;
+
+    std::vector<PlanetNode> m_selection;
+    std::vector<int> m_slots; // m_selection's vertex slots
+};
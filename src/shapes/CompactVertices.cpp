@@ -0,0 +1,71 @@
+#include "CompactVertices.h"
+
+#include <algorithm>
+#include <cmath>
+
+CompactBounds compactBounds(const Mesh &mesh) {
+    CompactBounds bounds;
+    if (mesh.vertexCount() == 0) return bounds;
+
+    glm::vec3 lo(INFINITY), hi(-INFINITY);
+    for (size_t i = 0; i < mesh.vertices.size(); i += Mesh::kFloatsPerVertex) {
+        glm::vec3 p(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    bounds.bias = lo;
+    for (int axis = 0; axis < 3; axis++) {
+        bounds.scale[axis] = hi[axis] > lo[axis] ? hi[axis] - lo[axis] : 1.f;
+    }
+    return bounds;
+}
+
+static uint16_t quantizeUnorm16(float v) {
+    return uint16_t(std::lround(std::clamp(v, 0.f, 1.f) * 65535.f));
+}
+
+static int8_t quantizeSnorm8(float v) {
+    return int8_t(std::lround(std::clamp(v, -1.f, 1.f) * 127.f));
+}
+
+static float signNotZero(float v) {
+    return v < 0.f ? -1.f : 1.f;
+}
+
+glm::i8vec2 encodeOctNormal(const glm::vec3 &n) {
+    // Project onto the octahedron |x| + |y| + |z| = 1 and fold the lower half over the upper
+    float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    glm::vec2 oct = l1 > 0.f ? glm::vec2(n.x, n.y) / l1 : glm::vec2(0.f);
+    if (n.z < 0.f) {
+        oct = glm::vec2((1.f - std::abs(oct.y)) * signNotZero(oct.x),
+                        (1.f - std::abs(oct.x)) * signNotZero(oct.y));
+    }
+    return glm::i8vec2(quantizeSnorm8(oct.x), quantizeSnorm8(oct.y));
+}
+
+void writeCompactVertices(const Mesh &mesh, const CompactBounds &bounds, CompactVertex *out) {
+    glm::vec3 invScale = 1.f / bounds.scale;
+    MeshWriter<CompactVertexFormat> writer(out, mesh.vertexCount());
+    const float *v = mesh.vertices.data();
+    for (int i = 0; i < mesh.vertexCount(); i++, v += Mesh::kFloatsPerVertex) {
+        glm::vec3 p = (glm::vec3(v[0], v[1], v[2]) - bounds.bias) * invScale;
+        glm::u16vec3 position(quantizeUnorm16(p.x), quantizeUnorm16(p.y), quantizeUnorm16(p.z));
+        writer.write(i, position, encodeOctNormal(glm::vec3(v[3], v[4], v[5])));
+    }
+}
+
+glm::vec3 decodePosition(const CompactVertex &vertex, const CompactBounds &bounds) {
+    glm::vec3 q(vertex.position[0], vertex.position[1], vertex.position[2]);
+    return bounds.bias + bounds.scale * (q / 65535.f);
+}
+
+glm::vec3 decodeNormal(const CompactVertex &vertex) {
+    // The same steps as the vertex shader; snorm8 decodes as max(c / 127, -1)
+    glm::vec2 oct(std::max(vertex.normal[0] / 127.f, -1.f), std::max(vertex.normal[1] / 127.f, -1.f));
+    glm::vec3 n(oct, 1.f - std::abs(oct.x) - std::abs(oct.y));
+    if (n.z < 0.f) {
+        n.x = (1.f - std::abs(oct.y)) * signNotZero(oct.x);
+        n.y = (1.f - std::abs(oct.x)) * signNotZero(oct.y);
+    }
+    return glm::normalize(n);
+}
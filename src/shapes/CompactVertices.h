@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "shapes/Mesh.h"
+#include "shapes/VertexFormat.h"
+
+// 8-byte alternative to Mesh's 24-byte (position, normal) vertices, for upload.
+//
+// Positions are unorm16 per axis inside the mesh's bounding box: decoded as bias + scale * q / 65535,
+// which the shader does with the posScale / posBias uniforms. Normals are octahedral-encoded into
+// two snorm8 components. The GL attributes are normalized, so no integer decoding is needed.
+using CompactVertexFormat = VertexFormat<Attribute<uint16_t, 3, true>, Attribute<int8_t, 2, true>>;
+
+// CompactVertexFormat as a struct, for reading vertices back
+struct CompactVertex
+{
+    uint16_t position[3];
+    int8_t normal[2];
+};
+static_assert(sizeof(CompactVertex) == CompactVertexFormat::stride &&
+              offsetof(CompactVertex, position) == CompactVertexFormat::offsets[0] &&
+              offsetof(CompactVertex, normal) == CompactVertexFormat::offsets[1],
+              "CompactVertex does not match CompactVertexFormat");
+
+struct CompactBounds
+{
+    glm::vec3 scale = glm::vec3(1.f);
+    glm::vec3 bias = glm::vec3(0.f);
+};
+
+// Bounding box of the mesh's positions; flat axes get a scale of 1 so they still decode exactly
+CompactBounds compactBounds(const Mesh &mesh);
+
+// Octahedral encoding of a unit normal into two snorm8 components, as stored in CompactVertex
+glm::i8vec2 encodeOctNormal(const glm::vec3 &normal);
+
+// Encodes every vertex of `mesh` into out[0, mesh.vertexCount()). `out` may be mapped GPU memory.
+void writeCompactVertices(const Mesh &mesh, const CompactBounds &bounds, CompactVertex *out);
+
+// What the GPU reconstructs, for checking the error bounds
+glm::vec3 decodePosition(const CompactVertex &vertex, const CompactBounds &bounds);
+glm::vec3 decodeNormal(const CompactVertex &vertex);
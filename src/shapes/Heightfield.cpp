@@ -0,0 +1,19 @@
+#include "Heightfield.h"
+
+void Heightfield::resize(int tiles, float origin, float size, float heightScale) {
+    m_tiles = tiles;
+    m_origin = origin;
+    m_size = size;
+    m_spacing = size / tiles;
+    m_heightScale = heightScale;
+    m_heights.assign(size_t(samplesPerSide()) * samplesPerSide(), 0.f);
+    m_slopeX.assign(m_heights.size(), 0.f);
+    m_slopeY.assign(m_heights.size(), 0.f);
+}
+
+glm::vec3 Heightfield::normal(int x, int y) const {
+    // Heights are scaled by m_heightScale, the normalized coordinates by 1 / m_size
+    size_t i = size_t(y) * samplesPerSide() + x;
+    float toWorld = m_heightScale / m_size;
+    return glm::normalize(glm::vec3(-m_slopeX[i] * toWorld, -m_slopeY[i] * toWorld, 1.f));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+// The terrain's (N+1) x (N+1) grid of tile corners, each sampled exactly once.
+// Mesh assembly reads positions and normals from here, and anything else that needs the
+// surface (picking, LOD, export, analysis) can reuse the same grid instead of re-sampling noise.
+class Heightfield
+{
+public:
+    // Resizes to `tiles` x `tiles` tiles covering [origin, origin + size) on both axes
+    void resize(int tiles, float origin, float size, float heightScale);
+
+    int tiles() const { return m_tiles; }
+    int samplesPerSide() const { return m_tiles + 1; }
+    float spacing() const { return m_spacing; }
+    float origin() const { return m_origin; }
+    float size() const { return m_size; }
+    float heightScale() const { return m_heightScale; }
+
+    // Grid coordinate of sample `i` along either axis
+    float coordinate(int i) const { return m_origin + i * m_spacing; }
+    // The same coordinate normalized to [0, 1], as taken by Terrain::getHeight()
+    float normalized(int i) const { return (coordinate(i) - m_origin) / m_size; }
+
+    // One row of constant y, samplesPerSide() unscaled heights long, for filling the grid.
+    // The slope rows hold the heights' partial derivatives with respect to the normalized coordinates.
+    float *row(int y) { return m_heights.data() + size_t(y) * samplesPerSide(); }
+    float *slopeXRow(int y) { return m_slopeX.data() + size_t(y) * samplesPerSide(); }
+    float *slopeYRow(int y) { return m_slopeY.data() + size_t(y) * samplesPerSide(); }
+    const std::vector<float> &heights() const { return m_heights; }
+
+    float height(int x, int y) const { return m_heightScale * m_heights[size_t(y) * samplesPerSide() + x]; }
+    glm::vec3 position(int x, int y) const { return {coordinate(x), coordinate(y), height(x, y)}; }
+
+    // Smooth vertex normal from the analytic slopes, independent of the grid resolution
+    glm::vec3 normal(int x, int y) const;
+
+private:
+    int m_tiles = 0;
+    float m_origin = 0.f;
+    float m_size = 1.f;
+    float m_spacing = 1.f;
+    float m_heightScale = 1.f;
+    std::vector<float> m_heights;
+    std::vector<float> m_slopeX;
+    std::vector<float> m_slopeY;
+};
+
+// A finished heightfield handed to another thread, shared read-only like MeshPtr
+using HeightfieldPtr = std::shared_ptr<const Heightfield>;
@@ -0,0 +1,158 @@
+#include "Icosphere.h"
+
+#include <algorithm>
+
+#include "util/Parallel.h"
+
+bool Icosphere::updateParams(int subdivisions, const CancelToken &cancel) {
+    subdivisions = std::clamp(subdivisions, 0, kMaxSubdivisions);
+    if (m_levels.empty()) makeBase();
+    while (levelCount() <= subdivisions) {
+        if (!subdivide(cancel)) return false;
+    }
+    m_mesh = m_levels[subdivisions];
+    return true;
+}
+
+// The icosahedron: three golden rectangles, counter-clockwise seen from outside
+void Icosphere::makeBase() {
+    const float t = (1.f + glm::sqrt(5.f)) / 2;
+    const glm::vec3 corners[12] = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1},
+    };
+    m_directions.clear();
+    for (const glm::vec3 &corner : corners) m_directions.push_back(glm::normalize(corner));
+
+    std::vector<uint32_t> indices = {
+        0, 11, 5,  0, 5, 1,   0, 1, 7,   0, 7, 10,  0, 10, 11,
+        1, 5, 9,   5, 11, 4,  11, 10, 2, 10, 7, 6,  7, 1, 8,
+        3, 9, 4,   3, 4, 2,   3, 2, 6,   3, 6, 8,   3, 8, 9,
+        4, 9, 5,   2, 4, 11,  6, 2, 10,  8, 6, 7,   9, 8, 1,
+    };
+    m_levels.push_back(makeMesh(std::move(indices)));
+}
+
+// Midpoint of each edge, by edge: an open-addressing table sized for one level's edges, which beats
+// std::unordered_map's node per entry by a wide margin here
+class MidpointCache
+{
+public:
+    explicit MidpointCache(size_t edges) {
+        size_t size = 1;
+        while (size < 2 * edges) size *= 2;
+        m_keys.assign(size, kEmpty);
+        m_values.resize(size);
+    }
+
+    // The slot for edge (a, b), in either order; `inserted` tells whether it was empty
+    uint32_t &find(uint32_t a, uint32_t b, bool &inserted) {
+        uint64_t key = uint64_t(std::min(a, b)) << 32 | std::max(a, b);
+        size_t mask = m_keys.size() - 1;
+        size_t slot = size_t((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+        while (m_keys[slot] != key && m_keys[slot] != kEmpty) slot = (slot + 1) & mask;
+        inserted = m_keys[slot] == kEmpty;
+        m_keys[slot] = key;
+        return m_values[slot];
+    }
+
+private:
+    static constexpr uint64_t kEmpty = ~uint64_t(0);
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_values;
+};
+
+static uint32_t meshIndex(const Mesh &mesh, size_t i) {
+    return mesh.wideIndices() ? mesh.indices32[i] : mesh.indices16[i];
+}
+
+// Appends the next level, splitting each triangle of the finest one into four
+bool Icosphere::subdivide(const CancelToken &cancel) {
+    const Mesh &coarse = *m_levels.back();
+    int triangles = coarse.triangleCount();
+    size_t coarseVertices = m_directions.size();
+
+    // Each edge is shared by two triangles; whichever reaches it first adds its midpoint
+    MidpointCache midpoints(size_t(triangles) * 3 / 2);
+    m_directions.reserve(coarseVertices + size_t(triangles) * 3 / 2);
+    auto midpoint = [&](uint32_t a, uint32_t b) {
+        bool inserted;
+        uint32_t &index = midpoints.find(a, b, inserted);
+        if (inserted) {
+            index = uint32_t(m_directions.size());
+            m_directions.push_back(glm::normalize(m_directions[a] + m_directions[b]));
+        }
+        return index;
+    };
+
+    std::vector<uint32_t> indices;
+    indices.reserve(size_t(triangles) * 12);
+    for (int i = 0; i < triangles; i++) {
+        if ((i & 4095) == 0 && cancel.isCancelled()) {
+            m_directions.resize(coarseVertices);
+            return false;
+        }
+        uint32_t a = meshIndex(coarse, 3 * size_t(i)), b = meshIndex(coarse, 3 * size_t(i) + 1);
+        uint32_t c = meshIndex(coarse, 3 * size_t(i) + 2);
+        uint32_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+        indices.insert(indices.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+    }
+    m_levels.push_back(makeMesh(std::move(indices)));
+    return true;
+}
+
+// Subdivision keeps each triangle's four children together, so the descendants of one triangle of a
+// coarse level are a run of the indices. The triangles of level kChunkLevel are the chunks: 1280 of them,
+// each small enough that those facing away from the camera can be dropped together.
+static constexpr int kChunkLevel = 3;
+
+MeshPtr Icosphere::makeMesh(std::vector<uint32_t> &&indices) const {
+    auto mesh = std::make_shared<Mesh>();
+    int count = int(m_directions.size());
+    MeshWriter<MeshVertexFormat> vertices = mesh->resizeVertices(count);
+    parallelFor(count, m_threads, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) vertices.write(i, m_directions[i] * m_radius, m_directions[i]);
+    });
+
+    int triangles = int(indices.size() / 3), level = 0;
+    while (triangleCount(level) < triangles) level++;
+    int chunks = triangleCount(std::min(level, kChunkLevel)), chunkTriangles = triangles / chunks;
+    struct Bound
+    {
+        glm::vec3 center = glm::vec3(0.f), axis;
+        float radius = 0, coneAngle = 0;
+    };
+    std::vector<Bound> bounds(chunks);
+    parallelFor(chunks, m_threads, [&](int begin, int end) {
+        for (int chunk = begin; chunk < end; chunk++) {
+            const uint32_t *first = &indices[size_t(chunk) * chunkTriangles * 3];
+            const uint32_t *last = first + size_t(chunkTriangles) * 3;
+            Bound &bound = bounds[chunk];
+            glm::vec3 sum(0.f);
+            for (const uint32_t *i = first; i < last; i += 3) {
+                glm::vec3 a = m_directions[i[0]], b = m_directions[i[1]], c = m_directions[i[2]];
+                bound.center += a + b + c;
+                sum += glm::cross(b - a, c - a); // counter-clockwise from outside, so outward
+            }
+            bound.center *= m_radius / float(3 * chunkTriangles);
+            bound.axis = glm::normalize(sum);
+            for (const uint32_t *i = first; i < last; i += 3) {
+                glm::vec3 a = m_directions[i[0]], b = m_directions[i[1]], c = m_directions[i[2]];
+                float cosine = glm::dot(bound.axis, glm::normalize(glm::cross(b - a, c - a)));
+                bound.coneAngle = std::max(bound.coneAngle, glm::acos(glm::clamp(cosine, -1.f, 1.f)));
+                for (const glm::vec3 &corner : {a, b, c}) {
+                    bound.radius = std::max(bound.radius, glm::distance(bound.center, corner * m_radius));
+                }
+            }
+        }
+    });
+    for (int c = 0; c < chunks; c++) {
+        const Bound &bound = bounds[c];
+        mesh->chunks.addSphere(c * chunkTriangles * 3, chunkTriangles * 3, bound.center, bound.radius, bound.axis,
+                               bound.coneAngle);
+    }
+
+    mesh->setIndices(std::move(indices));
+    return mesh;
+}
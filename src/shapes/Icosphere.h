@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "shapes/Mesh.h"
+#include "util/CancelToken.h"
+
+// Sphere built by repeatedly subdividing an icosahedron, an alternative to Sphere's latitude and
+// longitude grid. Every triangle is split into four through its edge midpoints, pushed back out onto
+// the sphere, so triangles stay within a small factor of each other in size instead of crowding
+// toward the poles: the same chord error takes far fewer of them.
+//
+// Vertices are shared between triangles; a midpoint cache keyed by edge gives each edge one midpoint.
+// Every finished level is kept, and a level's vertices are a prefix of the next one's, so moving
+// between levels already built reuses their meshes and a finer level only subdivides from the finest
+// so far.
+class Icosphere
+{
+public:
+    // 20 * 4^9 = 5.2M triangles
+    static constexpr int kMaxSubdivisions = 9;
+
+    // Makes the mesh at `subdivisions` levels (clamped to [0, kMaxSubdivisions]). Returns false,
+    // keeping the levels finished so far and the previous mesh, if cancelled.
+    bool updateParams(int subdivisions, const CancelToken &cancel = CancelToken());
+    // Worker threads used for the vertex pass; 0 means one per hardware thread
+    void setThreadCount(int threads) { m_threads = threads; }
+    // The last generated mesh, shared with the level cache rather than copied
+    MeshPtr generateShape() const { return m_mesh; }
+    // Levels built so far, 0 through levelCount() - 1
+    int levelCount() const { return int(m_levels.size()); }
+
+    static int vertexCount(int subdivisions) { return 10 * (1 << (2 * subdivisions)) + 2; }
+    static int triangleCount(int subdivisions) { return 20 * (1 << (2 * subdivisions)); }
+
+private:
+    void makeBase();
+    bool subdivide(const CancelToken &cancel);
+    MeshPtr makeMesh(std::vector<uint32_t> &&indices) const;
+
+    std::vector<glm::vec3> m_directions; // unit vertex directions, finest level so far
+    std::vector<MeshPtr> m_levels;
+    MeshPtr m_mesh;
+    float m_radius = 0.5;
+    int m_threads = 0;
+};
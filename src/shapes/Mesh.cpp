@@ -0,0 +1,68 @@
+#include "Mesh.h"
+
+#include <sstream>
+
+const void *Mesh::indexData() const {
+    if (wideIndices()) return indices32.data();
+    return indices16.data();
+}
+
+size_t Mesh::indexBytes() const {
+    return indices32.size() * sizeof(uint32_t) + indices16.size() * sizeof(uint16_t);
+}
+
+MeshWriter<MeshVertexFormat> Mesh::resizeVertices(int count) {
+    vertices.resize(size_t(count) * kFloatsPerVertex);
+    return MeshWriter<MeshVertexFormat>(vertices.data(), count);
+}
+
+void Mesh::setIndices(std::vector<uint32_t> &&indices) {
+    indices16.clear();
+    indices32.clear();
+
+    if (vertexCount() <= 0x10000) {
+        indices16.assign(indices.begin(), indices.end());
+    } else {
+        indices32 = std::move(indices);
+    }
+}
+
+void Mesh::clear() {
+    vertices.clear();
+    indices16.clear();
+    indices32.clear();
+    chunks.clear();
+}
+
+std::string Mesh::describe() const {
+    size_t indexedBytes = vertexBytes() + indexBytes();
+
+    std::ostringstream out;
+    out << triangleCount() << " triangles, "
+        << vertexCount() << " vertices (" << vertexBytes() << " B) + "
+        << indexCount() << (wideIndices() ? " 32-bit" : " 16-bit") << " indices (" << indexBytes() << " B) = "
+        << indexedBytes << " B indexed vs "
+        << triangleCount() * 3 << " vertices = " << soupBytes() << " B as triangle soup";
+    if (indexedBytes > 0) {
+        out << " (" << double(soupBytes()) / indexedBytes << "x)";
+    }
+    return out.str();
+}
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t bytes) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        hash = (hash ^ p[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t Mesh::contentHash() const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = fnv1a(hash, vertices.data(), vertexBytes());
+    for (int i = 0; i < indexCount(); i++) {
+        uint32_t index = wideIndices() ? indices32[i] : indices16[i];
+        hash = fnv1a(hash, &index, sizeof(index));
+    }
+    return hash;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shapes/MeshChunks.h"
+#include "shapes/VertexFormat.h"
+
+// Mesh's vertex layout: position, normal
+using MeshVertexFormat = VertexFormat<Attribute<float, 3>, Attribute<float, 3>>;
+
+// Indexed triangle mesh shared by the shape generators and GLWidget.
+// Vertices are deduplicated and interleaved (position, normal); triangles index into them.
+// Indices are stored 16-bit whenever every vertex is addressable that way, 32-bit otherwise.
+struct Mesh
+{
+    static constexpr int kFloatsPerVertex = int(MeshVertexFormat::stride / sizeof(float));
+    static_assert(MeshVertexFormat::stride % sizeof(float) == 0, "Mesh stores its vertices as floats");
+
+    std::vector<float> vertices;
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+    // Spatial runs of the indices, for culling; empty when the generator does not split its mesh.
+    // Derived from the geometry, so contentHash() leaves them out.
+    MeshChunks chunks;
+
+    int vertexCount() const { return int(vertices.size()) / kFloatsPerVertex; }
+    int indexCount() const { return int(wideIndices() ? indices32.size() : indices16.size()); }
+    int triangleCount() const { return indexCount() / 3; }
+
+    bool wideIndices() const { return !indices32.empty(); }
+    const void *indexData() const;
+
+    size_t vertexBytes() const { return vertices.size() * sizeof(float); }
+    size_t indexBytes() const;
+    // What the same triangles would take as non-indexed triangle soup
+    size_t soupBytes() const { return size_t(triangleCount()) * 3 * kFloatsPerVertex * sizeof(float); }
+
+    // Sizes the vertex array for exactly `count` vertices and returns a writer over it.
+    // Disjoint vertices may be written from different threads.
+    MeshWriter<MeshVertexFormat> resizeVertices(int count);
+
+    // Takes 32-bit indices and narrows them to 16 bits if the vertex count allows it
+    void setIndices(std::vector<uint32_t> &&indices);
+    void clear();
+
+    // Triangle and byte counts, indexed versus triangle soup
+    std::string describe() const;
+
+    // FNV-1a over the vertex bits and the indices (as 32-bit values, so index width does not matter).
+    // Equal hashes mean bit-identical geometry.
+    uint64_t contentHash() const;
+};
+
+// How finished meshes are handed around. A generator writes each mesh exactly once into a fresh
+// Mesh and never touches it again after publishing, so any number of readers (worker hand-off,
+// GL upload, export) can share it without copying or locking.
+using MeshPtr = std::shared_ptr<const Mesh>;
@@ -0,0 +1,181 @@
+#include "MeshChunks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_CHUNKS_SSE2 1
+#endif
+
+void MeshChunks::clear() {
+    for (std::vector<int> *v : {&firstIndex, &indexCount}) v->clear();
+    for (std::vector<float> *v : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ, &centerX, &centerY, &centerZ, &radius,
+                                  &axisX, &axisY, &axisZ, &coneCos, &coneSin}) {
+        v->clear();
+    }
+}
+
+void MeshChunks::addBox(int first, int count, const glm::vec3 &lo, const glm::vec3 &hi) {
+    bounds = Bounds::Boxes;
+    firstIndex.push_back(first);
+    indexCount.push_back(count);
+    minX.push_back(lo.x);
+    minY.push_back(lo.y);
+    minZ.push_back(lo.z);
+    maxX.push_back(hi.x);
+    maxY.push_back(hi.y);
+    maxZ.push_back(hi.z);
+}
+
+void MeshChunks::addSphere(int first, int count, const glm::vec3 &center, float r, const glm::vec3 &axis,
+                           float coneAngle) {
+    bounds = Bounds::Spheres;
+    firstIndex.push_back(first);
+    indexCount.push_back(count);
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    radius.push_back(r);
+    axisX.push_back(axis.x);
+    axisY.push_back(axis.y);
+    axisZ.push_back(axis.z);
+    // A cone of half a turn or more never faces away; (0, 1) makes the test below always fail
+    bool wide = coneAngle >= glm::half_pi<float>();
+    coneCos.push_back(wide ? 0.f : std::cos(coneAngle));
+    coneSin.push_back(wide ? 1.f : std::sin(coneAngle));
+}
+
+namespace {
+
+// Frustum planes straight from the matrix rows (Gribb & Hartmann), inside where dot >= 0, as in
+// LodQuadtree::select(). Normalized, so sphere radii can be compared with the distances.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    explicit Frustum(const glm::mat4 &viewProj) {
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++) rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+        glm::vec4 p[6] = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                          rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+        for (int i = 0; i < 6; i++) {
+            float length = glm::length(glm::vec3(p[i]));
+            planes[i] = length > 0 ? p[i] / length : p[i];
+        }
+    }
+};
+
+} // namespace
+
+// True if the box is entirely behind one of the planes
+static bool boxOutside(const MeshChunks &chunks, int c, const Frustum &frustum) {
+    for (const glm::vec4 &p : frustum.planes) {
+        float x = p.x >= 0 ? chunks.maxX[c] : chunks.minX[c];
+        float y = p.y >= 0 ? chunks.maxY[c] : chunks.minY[c];
+        float z = p.z >= 0 ? chunks.maxZ[c] : chunks.minZ[c];
+        if ((p.x * x + p.y * y) + (p.z * z + p.w) < 0) return true;
+    }
+    return false;
+}
+
+// True if the sphere is entirely behind one of the planes, or if every face normal in the cone points
+// away from the eye at every point of the sphere: with v from the eye to the centre and phi the angle
+// between v and the axis, the normal closest to facing the eye is phi + coneAngle away from v, so the
+// chunk faces away when |v| cos(phi + coneAngle) >= radius.
+static bool sphereHidden(const MeshChunks &chunks, int c, const Frustum &frustum, const glm::vec3 &eye) {
+    glm::vec3 center(chunks.centerX[c], chunks.centerY[c], chunks.centerZ[c]);
+    float r = chunks.radius[c];
+    for (const glm::vec4 &p : frustum.planes) {
+        if ((p.x * center.x + p.y * center.y) + (p.z * center.z + p.w) < -r) return true;
+    }
+    glm::vec3 v = center - eye;
+    float along = glm::dot(glm::vec3(chunks.axisX[c], chunks.axisY[c], chunks.axisZ[c]), v);
+    float across = std::sqrt(std::max(0.f, glm::dot(v, v) - along * along));
+    return along * chunks.coneCos[c] - across * chunks.coneSin[c] >= r;
+}
+
+// The SIMD path below adds in the same order, so both give the same answer for every chunk
+int MeshChunks::cullScalar(const glm::mat4 &viewProj, const glm::vec3 &eye, std::vector<uint8_t> &visible) const {
+    Frustum frustum(viewProj);
+    int n = count(), seen = 0;
+    visible.resize(size_t(n));
+    for (int c = 0; c < n; c++) {
+        bool hidden = bounds == Bounds::Boxes ? boxOutside(*this, c, frustum) : sphereHidden(*this, c, frustum, eye);
+        visible[c] = !hidden;
+        seen += !hidden;
+    }
+    return seen;
+}
+
+int MeshChunks::cull(const glm::mat4 &viewProj, const glm::vec3 &eye, std::vector<uint8_t> &visible) const {
+#ifndef MESH_CHUNKS_SSE2
+    return cullScalar(viewProj, eye, visible);
+#else
+    Frustum frustum(viewProj);
+    int n = count(), seen = 0;
+    visible.resize(size_t(n));
+
+    // Four chunks per pass; the last few go through the scalar test
+    int c = 0;
+    if (bounds == Bounds::Boxes) {
+        for (; c + 4 <= n; c += 4) {
+            __m128 outside = _mm_setzero_ps();
+            for (const glm::vec4 &p : frustum.planes) {
+                // The plane is the same for all four, so it picks the same corner of each box
+                __m128 x = _mm_loadu_ps((p.x >= 0 ? maxX : minX).data() + c);
+                __m128 y = _mm_loadu_ps((p.y >= 0 ? maxY : minY).data() + c);
+                __m128 z = _mm_loadu_ps((p.z >= 0 ? maxZ : minZ).data() + c);
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), x), _mm_mul_ps(_mm_set1_ps(p.y), y)),
+                                      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), z), _mm_set1_ps(p.w)));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+            }
+            int mask = _mm_movemask_ps(outside);
+            for (int k = 0; k < 4; k++) {
+                visible[c + k] = !(mask >> k & 1);
+                seen += visible[c + k];
+            }
+        }
+        for (; c < n; c++) {
+            visible[c] = !boxOutside(*this, c, frustum);
+            seen += visible[c];
+        }
+        return seen;
+    }
+
+    __m128 eyeX = _mm_set1_ps(eye.x), eyeY = _mm_set1_ps(eye.y), eyeZ = _mm_set1_ps(eye.z);
+    for (; c + 4 <= n; c += 4) {
+        __m128 x = _mm_loadu_ps(centerX.data() + c);
+        __m128 y = _mm_loadu_ps(centerY.data() + c);
+        __m128 z = _mm_loadu_ps(centerZ.data() + c);
+        __m128 r = _mm_loadu_ps(radius.data() + c);
+        __m128 minusR = _mm_sub_ps(_mm_setzero_ps(), r);
+        __m128 hidden = _mm_setzero_ps();
+        for (const glm::vec4 &p : frustum.planes) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), x), _mm_mul_ps(_mm_set1_ps(p.y), y)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), z), _mm_set1_ps(p.w)));
+            hidden = _mm_or_ps(hidden, _mm_cmplt_ps(d, minusR));
+        }
+        __m128 vx = _mm_sub_ps(x, eyeX), vy = _mm_sub_ps(y, eyeY), vz = _mm_sub_ps(z, eyeZ);
+        __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(axisX.data() + c), vx),
+                                             _mm_mul_ps(_mm_loadu_ps(axisY.data() + c), vy)),
+                                  _mm_mul_ps(_mm_loadu_ps(axisZ.data() + c), vz));
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+        __m128 across = _mm_sqrt_ps(_mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(lengthSq, _mm_mul_ps(along, along))));
+        __m128 facing = _mm_sub_ps(_mm_mul_ps(along, _mm_loadu_ps(coneCos.data() + c)),
+                                   _mm_mul_ps(across, _mm_loadu_ps(coneSin.data() + c)));
+        hidden = _mm_or_ps(hidden, _mm_cmpge_ps(facing, r));
+
+        int mask = _mm_movemask_ps(hidden);
+        for (int k = 0; k < 4; k++) {
+            visible[c + k] = !(mask >> k & 1);
+            seen += visible[c + k];
+        }
+    }
+    for (; c < n; c++) {
+        visible[c] = !sphereHidden(*this, c, frustum, eye);
+        seen += visible[c];
+    }
+    return seen;
+#endif
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// A mesh's triangles split into spatially compact runs of its index buffer, each with bounds, so a
+// renderer can leave out the ones that cannot be seen. Open surfaces such as the terrain get boxes,
+// tested against the view frustum. Closed ones such as the icosphere get bounding spheres and cones
+// around their face normals, so chunks that face away from the camera are left out as well.
+//
+// The bounds are stored structure-of-arrays, and cull() tests four chunks against each plane per
+// SSE2 instruction (x86-64 always has it; other targets take the scalar path).
+struct MeshChunks
+{
+    enum class Bounds { Boxes, Spheres };
+
+    Bounds bounds = Bounds::Boxes;
+    std::vector<int> firstIndex;  // each chunk's run of the index buffer
+    std::vector<int> indexCount;
+    // Boxes: minimum and maximum corners
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    // Spheres: centre and radius, and the normal cone's axis and the cosine and sine of its half-angle
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> axisX, axisY, axisZ, coneCos, coneSin;
+
+    int count() const { return int(firstIndex.size()); }
+    bool empty() const { return firstIndex.empty(); }
+    void clear();
+
+    void addBox(int first, int count, const glm::vec3 &lo, const glm::vec3 &hi);
+    // `coneAngle` is the largest angle, in radians, between `axis` and any of the chunk's face normals
+    void addSphere(int first, int count, const glm::vec3 &center, float radius, const glm::vec3 &axis, float coneAngle);
+
+    // Sets `visible[c]` to whether chunk c may be seen through `viewProj`, the mesh's model-view-projection
+    // matrix, from `eye`, the camera in mesh coordinates. Returns the number of visible chunks.
+    int cull(const glm::mat4 &viewProj, const glm::vec3 &eye, std::vector<uint8_t> &visible) const;
+    // The same test one chunk at a time: the reference the SIMD path is checked and benchmarked against
+    int cullScalar(const glm::mat4 &viewProj, const glm::vec3 &eye, std::vector<uint8_t> &visible) const;
+};
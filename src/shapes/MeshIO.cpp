@@ -0,0 +1,105 @@
+#include "MeshIO.h"
+
+#include <charconv>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Index i of either index width
+uint32_t indexAt(const Mesh &mesh, int i) {
+    return mesh.wideIndices() ? mesh.indices32[i] : mesh.indices16[i];
+}
+
+// Formats into a local buffer and flushes it in large blocks; OBJ output is mostly number formatting
+class TextBuffer
+{
+public:
+    explicit TextBuffer(std::ostream &out) : m_out(out) { m_buffer.reserve(kCapacity + 256); }
+    ~TextBuffer() { flush(); }
+
+    void text(const char *s) {
+        m_buffer.insert(m_buffer.end(), s, s + std::strlen(s));
+    }
+    void number(float f) {
+        char digits[32];
+        m_buffer.insert(m_buffer.end(), digits, std::to_chars(digits, digits + sizeof(digits), f).ptr);
+    }
+    void number(uint32_t u) {
+        char digits[16];
+        m_buffer.insert(m_buffer.end(), digits, std::to_chars(digits, digits + sizeof(digits), u).ptr);
+    }
+    void endLine() {
+        m_buffer.push_back('\n');
+        if (m_buffer.size() >= kCapacity) flush();
+    }
+    void flush() {
+        m_out.write(m_buffer.data(), std::streamsize(m_buffer.size()));
+        m_buffer.clear();
+    }
+
+private:
+    static constexpr size_t kCapacity = 1 << 16;
+    std::ostream &m_out;
+    std::vector<char> m_buffer;
+};
+
+} // namespace
+
+bool writeObj(const Mesh &mesh, std::ostream &out) {
+    {
+        TextBuffer text(out);
+        for (int attribute = 0; attribute < 2; attribute++) {
+            const char *prefix = attribute == 0 ? "v" : "vn";
+            for (int v = 0; v < mesh.vertexCount(); v++) {
+                const float *p = &mesh.vertices[v * Mesh::kFloatsPerVertex + attribute * 3];
+                text.text(prefix);
+                for (int k = 0; k < 3; k++) {
+                    text.text(" ");
+                    text.number(p[k]);
+                }
+                text.endLine();
+            }
+        }
+        for (int i = 0; i < mesh.indexCount(); i += 3) {
+            text.text("f");
+            for (int k = 0; k < 3; k++) {
+                uint32_t index = indexAt(mesh, i + k) + 1;
+                text.text(" ");
+                text.number(index);
+                text.text("//");
+                text.number(index);
+            }
+            text.endLine();
+        }
+    }
+    return bool(out);
+}
+
+bool writePly(const Mesh &mesh, std::ostream &out) {
+    out << "ply\n"
+        << "format binary_little_endian 1.0\n"
+        << "element vertex " << mesh.vertexCount() << "\n"
+        << "property float x\nproperty float y\nproperty float z\n"
+        << "property float nx\nproperty float ny\nproperty float nz\n"
+        << "element face " << mesh.triangleCount() << "\n"
+        << "property list uchar int vertex_indices\n"
+        << "end_header\n";
+
+    // The interleaved vertex buffer already is the PLY vertex layout (assuming a little-endian host)
+    out.write(reinterpret_cast<const char *>(mesh.vertices.data()), std::streamsize(mesh.vertexBytes()));
+
+    // 13 bytes per face: a count of 3, then three 32-bit indices
+    constexpr int kFaceBytes = 1 + 3 * sizeof(int32_t);
+    std::vector<char> faces(size_t(mesh.triangleCount()) * kFaceBytes);
+    for (int t = 0; t < mesh.triangleCount(); t++) {
+        char *face = &faces[size_t(t) * kFaceBytes];
+        face[0] = 3;
+        for (int k = 0; k < 3; k++) {
+            int32_t index = int32_t(indexAt(mesh, t * 3 + k));
+            std::memcpy(face + 1 + k * sizeof(int32_t), &index, sizeof(index));
+        }
+    }
+    out.write(faces.data(), std::streamsize(faces.size()));
+    return bool(out);
+}
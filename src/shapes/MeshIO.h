@@ -0,0 +1,15 @@
+#pragma once
+
+#include <ostream>
+
+#include "shapes/Mesh.h"
+
+// Writes a Mesh for other tools. Both formats keep the indexed vertices and their normals.
+// Return false if the stream failed.
+
+// Wavefront OBJ, text: v / vn lines, then faces as 1-based "f a//a b//b c//c"
+bool writeObj(const Mesh &mesh, std::ostream &out);
+
+// Stanford PLY, binary little-endian: float x y z nx ny nz per vertex, then uchar-counted int faces.
+// Much smaller and faster to write and parse than OBJ for large meshes.
+bool writePly(const Mesh &mesh, std::ostream &out);
@@ -1,121 +1,110 @@
 #include "Sphere.h"
 #include "glm/ext/scalar_constants.hpp"
+#include "util/Parallel.h"
 
 void Sphere::updateParams(int param1, int param2) {
-    m_vertexData = std::vector<float>();
+    // Start a new mesh rather than clearing the old one, which callers may still hold
+    m_mesh = std::make_shared<Mesh>();
     m_param1 = param1;
     m_param2 = param2;
     setVertexData();
 }
 
-void Sphere::makeTile(glm::vec3 topLeft,
-                      glm::vec3 topRight,
-                      glm::vec3 bottomLeft,
-                      glm::vec3 bottomRight) {
-    // Task 5: Implement the makeTile() function for a Sphere
-    // Note: this function is very similar to the makeTile() function for Cube,
-    //       but the normals are calculated in a different way!
+// Vertices are shared between tiles: one per pole, and m_param2 per ring of latitude in between.
+// The ring wraps around, so the seam at theta = 2pi reuses the vertices at theta = 0.
+uint32_t Sphere::vertexIndex(int phiIndex, int thetaIndex) const {
+    if (phiIndex == 0) return 0;
+    if (phiIndex == m_param1) return 1 + (m_param1 - 1) * m_param2;
+    return 1 + (phiIndex - 1) * m_param2 + (thetaIndex % m_param2);
+}
+
+void Sphere::makeVertices() {
+    float phiInterval = 180.0 / m_param1;
+    float thetaStep = glm::radians(360.f / m_param2);
     glm::vec3 center = {0.0, 0.0, 0.0};
-    glm::vec3 TLnormal = glm::normalize(topLeft - center);
-    glm::vec3 TRnormal = glm::normalize(topRight - center);
-    glm::vec3 BLnormal = glm::normalize(bottomLeft - center);
-    glm::vec3 BRnormal = glm::normalize(bottomRight - center);
 
-    // multiply the point by the unique perlin value associated with its x, y ,z value (1 + that?)
-    // need to modify the perlin noise evaluate function to incorporate the z value
-    // topLeft = topLeft * (1 + evaluatePerlinNoise(topLeft))
+    int rings = m_param1 > 1 ? m_param1 - 1 : 0;
+    MeshWriter<MeshVertexFormat> vertices = m_mesh->resizeVertices(2 + rings * m_param2);
+
+    // Each ring of latitude writes its own slice of the presized buffer
+    parallelFor(m_param1 + 1, m_threads, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            float phi = glm::radians(i * phiInterval);
+            float sinPhi = glm::sin(phi);
+            float cosPhi = glm::cos(phi);
+
+            // The poles are a single vertex each
+            int ringSize = (i == 0 || i == m_param1) ? 1 : m_param2;
+            for (int j = 0; j < ringSize; j++) {
+                float theta = j * thetaStep;
+                glm::vec3 position = {m_radius * sinPhi * glm::sin(theta), m_radius * cosPhi, m_radius * sinPhi * glm::cos(theta)};
+
+                // multiply the point by the unique perlin value associated with its x, y ,z value (1 + that?)
+                // need to modify the perlin noise evaluate function to incorporate the z value
+                // position = position * (1 + evaluatePerlinNoise(position))
+
+                vertices.write(vertexIndex(i, j), position, glm::normalize(position - center));
+            }
+        }
+    });
+}
 
+// Writes the tile's triangles at `indices` and returns the number of indices written
+int Sphere::makeTile(uint32_t *indices,
+                     uint32_t topLeft,
+                     uint32_t topRight,
+                     uint32_t bottomLeft,
+                     uint32_t bottomRight) {
+    // Tiles touching a pole collapse one of their triangles; skip it
+    int count = 0;
 
     // triangle 1
-    insertVec3(m_vertexData, topLeft);
-    insertVec3(m_vertexData, TLnormal);
-    insertVec3(m_vertexData, bottomLeft);
-    insertVec3(m_vertexData, BLnormal);
-    insertVec3(m_vertexData, bottomRight);
-    insertVec3(m_vertexData, BRnormal);
+    if (bottomLeft != bottomRight) {
+        indices[count++] = topLeft;
+        indices[count++] = bottomLeft;
+        indices[count++] = bottomRight;
+    }
 
     // triangle 2
-    insertVec3(m_vertexData, topLeft);
-    insertVec3(m_vertexData, TLnormal);
-    insertVec3(m_vertexData, bottomRight);
-    insertVec3(m_vertexData, BRnormal);
-    insertVec3(m_vertexData, topRight);
-    insertVec3(m_vertexData, TRnormal);
+    if (topLeft != topRight) {
+        indices[count++] = topLeft;
+        indices[count++] = bottomRight;
+        indices[count++] = topRight;
+    }
+    return count;
 }
 
-void Sphere::makeWedge(float currentTheta, float nextTheta) {
-    // Task 6: create a single wedge of the sphere using the
-    //         makeTile() function you implemented in Task 5
-    // Note: think about how param 1 comes into play here!
-
-    // 180 / param1 = sideLength of Tile
-    // param1 = # of tiles
-    // current Theta is left
-    glm::vec3 topLeft;
-    glm::vec3 topRight;
-    glm::vec3 bottomLeft;
-    glm::vec3 bottomRight;
-
-    float phiInterval = 180.0 / m_param1;
-    float x; // = 0.5 * glm::sin(phi) * glm::sin(theta);
-    float y; // = 0.5 * glm::cos(phi);
-    float z; // = 0.5 * glm::sin(phi) * glm::cos(theta);
-
-    float sinCurTheta = glm::sin(nextTheta);
-    float sinNextTheta = glm::sin(currentTheta);
-
-    float cosCurTheta = glm::cos(nextTheta);
-    float cosNextTheta = glm::cos(currentTheta);
+// Every wedge has the same number of triangles: two per tile, minus the collapsed one at each pole
+int Sphere::wedgeIndexCount() const {
+    return 6 * m_param1 - 6;
+}
 
+void Sphere::makeWedge(uint32_t *indices, int thetaIndex) {
+    // The wedge between thetaIndex and thetaIndex + 1, one tile per step of phi.
+    // As before, the left edge of each tile is the next theta and the top edge the next phi.
     for (int i = 0; i < m_param1; i++) {
-        float bottomPhi = (float)i * phiInterval;
-        float topPhi = bottomPhi + phiInterval;
-
-        float sinTopPhi = glm::sin(glm::radians(topPhi));
-        float sinBottomPhi = glm::sin(glm::radians(bottomPhi));
-
-        float cosTopPhi = glm::cos(glm::radians(topPhi));
-        float cosBottomPhi = glm::cos(glm::radians(bottomPhi));
+        uint32_t topLeft = vertexIndex(i + 1, thetaIndex + 1);
+        uint32_t topRight = vertexIndex(i + 1, thetaIndex);
+        uint32_t bottomLeft = vertexIndex(i, thetaIndex + 1);
+        uint32_t bottomRight = vertexIndex(i, thetaIndex);
 
-        topLeft = {0.5 * sinTopPhi * sinCurTheta, 0.5 * cosTopPhi, 0.5 * sinTopPhi * cosCurTheta};
-        topRight = {0.5 * sinTopPhi * sinNextTheta, 0.5 * cosTopPhi, 0.5 * sinTopPhi * cosNextTheta};
-        bottomLeft = {0.5 * sinBottomPhi * sinCurTheta, 0.5 * cosBottomPhi, 0.5 * sinBottomPhi * cosCurTheta};
-        bottomRight = {0.5 * sinBottomPhi * sinNextTheta, 0.5 * cosBottomPhi, 0.5 * sinBottomPhi * cosNextTheta};
-
-        makeTile(topLeft, topRight, bottomLeft, bottomRight);
+        indices += makeTile(indices, topLeft, topRight, bottomLeft, bottomRight);
     }
 }
 
 void Sphere::makeSphere() {
-    // Task 7: create a full sphere using the makeWedge() function you
-    //         implemented in Task 6
-    // Note: think about how param 2 comes into play here!
-
-    float thetaStep = glm::radians(360.f / m_param2);
-    for (int i = 0; i < m_param2; i++) {
-         float currentTheta = i * thetaStep;
-         float nextTheta = currentTheta + thetaStep;
-         makeWedge(currentTheta, nextTheta);
-    }
+    makeVertices();
+
+    // Wedges are spread across the worker threads, each writing its own fixed-size slice
+    std::vector<uint32_t> indices(size_t(wedgeIndexCount()) * m_param2);
+    parallelFor(m_param2, m_threads, [&](int begin, int end) {
+        for (int j = begin; j < end; j++) {
+            makeWedge(&indices[size_t(j) * wedgeIndexCount()], j);
+        }
+    });
+    m_mesh->setIndices(std::move(indices));
 }
 
 void Sphere::setVertexData() {
-    // Uncomment these lines to make a wedge for Task 6, then comment them out for Task 7:
-
-//     float thetaStep = glm::radians(360.f / m_param2);
-//     float currentTheta = 0 * thetaStep;
-//     float nextTheta = 1 * thetaStep;
-//     makeWedge(currentTheta, nextTheta);
-
-    // Uncomment these lines to make sphere for Task 7:
-
-     makeSphere();
-}
-
-// Inserts a glm::vec3 into a vector of floats.
-// This will come in handy if you want to take advantage of vectors to build your shape!
-void Sphere::insertVec3(std::vector<float> &data, glm::vec3 v) {
-    data.push_back(v.x);
-    data.push_back(v.y);
-    data.push_back(v.z);
+    makeSphere();
 }
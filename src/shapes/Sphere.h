@@ -3,24 +3,35 @@
 #include <vector>
 #include <glm/glm.hpp>
 
+#include "shapes/Mesh.h"
+
 class Sphere
 {
 public:
     void updateParams(int param1, int param2);
-    std::vector<float> generateShape() { return m_vertexData; }
+    // Largest param1 and param2 accepted from outside: 16.8M vertices at both
+    static constexpr int kMaxSegments = 4096;
+    // Worker threads used by generation; 0 means one per hardware thread. The output does not depend on it.
+    void setThreadCount(int threads) { m_threads = threads; }
+    // The last generated mesh, shared rather than copied; later updates build a new one
+    MeshPtr generateShape() const { return m_mesh; }
 
 private:
-    void insertVec3(std::vector<float> &data, glm::vec3 v);
     void setVertexData();
-    void makeTile(glm::vec3 topLeft,
-                  glm::vec3 topRight,
-                  glm::vec3 bottomLeft,
-                  glm::vec3 bottomRight);
-    void makeWedge(float currTheta, float nextTheta);
+    uint32_t vertexIndex(int phiIndex, int thetaIndex) const;
+    void makeVertices();
+    int makeTile(uint32_t *indices,
+                 uint32_t topLeft,
+                 uint32_t topRight,
+                 uint32_t bottomLeft,
+                 uint32_t bottomRight);
+    int wedgeIndexCount() const;
+    void makeWedge(uint32_t *indices, int thetaIndex);
     void makeSphere();
 
-    std::vector<float> m_vertexData;
+    std::shared_ptr<Mesh> m_mesh = std::make_shared<Mesh>(); // written only until it is replaced
     float m_radius = 0.5;
     int m_param1;
     int m_param2;
+    int m_threads = 0;
 };
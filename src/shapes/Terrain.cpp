@@ -1,23 +1,27 @@
 #include "Terrain.h"
 
-void Terrain::updateParams(int param1) {
-    m_vertexData = std::vector<float>();
-    m_param1 = param1;
-    m_lookupSize = 1024;
+#include <algorithm>
+#include <cmath>
+#include <mutex>
 
-    m_randVecLookup.reserve(m_lookupSize);
+#include "util/Parallel.h"
 
-    // Initialize random number generator
-    std::srand(1230);
+bool Terrain::updateParams(int param1, const CancelToken &cancel) {
+    // Start a new mesh rather than clearing the old one, which callers may still hold
+    m_mesh = std::make_shared<Mesh>();
+    m_param1 = param1;
 
-    // Populate random vector lookup table
-    for (int i = 0; i < m_lookupSize; i++)
-    {
-      m_randVecLookup.push_back(glm::vec2(std::rand() * 2.0 / RAND_MAX - 1.0,
-                                          std::rand() * 2.0 / RAND_MAX - 1.0));
-    }
+    return makeFace(cancel);
+}
+
+bool Terrain::updateHeightfield(int param1, const CancelToken &cancel) {
+    m_param1 = param1;
+    makeHeightfield(cancel);
+    return !cancel.isCancelled();
+}
 
-    makeFace();
+void Terrain::setSeed(uint32_t seed) {
+    m_perlin.setTable(GradientTable::forSeed(seed));
 }
 
 // ====================================== PERLIN HELPERS ====================================== //
@@ -30,16 +34,14 @@ float Terrain::interpolate(float A, float B, float alpha) {
 
 // Samples the (infinite) random vector grid at (row, col)
 glm::vec2 Terrain::sampleRandomVector(int row, int col) {
-    std::hash<int> intHash;
-    int index = intHash(row * 41 + col * 43) % m_lookupSize;
-    return m_randVecLookup.at(index);
+    return m_perlin.table().gradient(row, col);
 }
 
 // Computes the intensity of Perlin noise at some point
 float Terrain::computePerlin(float x, float y) {
-    // Get grid indices (as ints)
-    int X = (int)x;
-    int Y = (int)y;
+    // Get grid indices (as ints), flooring so negative coordinates land in the right cell
+    int X = (int)std::floor(x);
+    int Y = (int)std::floor(y);
     glm::vec2 i1 = {X, Y};
     glm::vec2 i2 = {X + 1, Y};
     glm::vec2 i3 = {X, Y + 1};
@@ -72,90 +74,139 @@ float Terrain::getHeight(float x, float y) {
 
     float z = 0;
 
-    // Combine multiple different octaves of noise to produce fractal perlin noise
-    z += computePerlin(x * 8, y * 8) / 8;
-    z += computePerlin(x * 16, y * 16) / 16;
-    z += computePerlin(x * 32, y * 32) / 32;
-    z += computePerlin(x * 64, y * 64) / 64;
+    // Combine multiple different octaves of noise to produce fractal perlin noise.
+    // Scalar reference for m_perlin, which runs the same octaves through an unrolled kernel
+    for (int o = 0; o < m_perlin.octaves(); o++) {
+        float frequency = fbmFrequency<DefaultFbm>(o);
+        z += computePerlin(x * frequency, y * frequency) * fbmAmplitude<DefaultFbm>(o);
+    }
 
     return z;
 }
 
 // ====================================== BASE PLANE ====================================== //
 
-void Terrain::makeTile(glm::vec3 topLeft,
-                    glm::vec3 topRight,
-                    glm::vec3 bottomLeft,
-                    glm::vec3 bottomRight) {
-
-    //normals are destination - source
-    glm::vec3 TLnormal = glm::normalize(glm::cross(bottomLeft - topLeft, topRight - topLeft));
-    glm::vec3 TRnormal = glm::normalize(glm::cross(topLeft - topRight, bottomRight - topRight));
-    glm::vec3 BLnormal = glm::normalize(glm::cross(bottomRight - bottomLeft, topLeft - bottomLeft));
-    glm::vec3 BRnormal = glm::normalize(glm::cross(topRight - bottomRight, bottomLeft - bottomRight));
-
-    // triangle 1
-    insertVec3(m_vertexData, topLeft);
-    insertVec3(m_vertexData, TLnormal);
-    insertVec3(m_vertexData, bottomLeft);
-    insertVec3(m_vertexData, BLnormal);
-    insertVec3(m_vertexData, bottomRight);
-    insertVec3(m_vertexData, BRnormal);
-
-    // triangle 2
-    insertVec3(m_vertexData, topLeft);
-    insertVec3(m_vertexData, TLnormal);
-    insertVec3(m_vertexData, bottomRight);
-    insertVec3(m_vertexData, BRnormal);
-    insertVec3(m_vertexData, topRight);
-    insertVec3(m_vertexData, TRnormal);
+// Tiles along each side: 5 per unit of param1, and a coarser preview divides that (keeping at least one)
+int Terrain::tileCount(int param1, int resolutionDivisor) {
+    int resolution = 5;
+    return std::max(1, param1 * resolution / resolutionDivisor);
 }
 
-void Terrain::makeFace() {
-
-    glm::vec3 topLeft, topRight, bottomLeft, bottomRight;
-
-    float m_resolution = 5.0;
+// Samples every tile corner exactly once, one row at a time through the scanline evaluator.
+// Rows are split into bands across m_threads worker threads.
+void Terrain::makeHeightfield(const CancelToken &cancel) {
     float m_terrainSize = 10.0;
     float m_halfRes = m_terrainSize / 2.0;
     float m_heightMultiplier = m_terrainSize; // terrain size gives best default results, but this can be modified as desired
 
-    float xVal, xValLong;
-    float yVal, yValLong;
-    float zVal;
-
+    m_heightfield.resize(tileCount(m_param1, m_resolutionDivisor), -m_halfRes, m_terrainSize, m_heightMultiplier);
 
-    float sideLength = m_terrainSize / (m_param1 * m_resolution);
-    for (int x = 0; x < (m_param1 * m_resolution); x ++) {
-        xVal = -m_halfRes + (x * sideLength);
-        xValLong = xVal + sideLength;
+    int samples = m_heightfield.samplesPerSide();
+    std::vector<float> sampleX(samples);
+    for (int x = 0; x < samples; x++) {
+        sampleX[x] = m_heightfield.normalized(x);
+    }
 
-        for (int y = 0; y < (m_param1 * m_resolution); y ++) {
-            yVal = -m_halfRes + (y * sideLength);
-            yValLong = yVal + sideLength;
+    parallelFor(samples, m_threads, [&](int begin, int end) {
+        for (int y = begin; y < end && !cancel.isCancelled(); y++) {
+            m_perlin.getHeightRow(sampleX.data(), m_heightfield.normalized(y), m_heightfield.row(y),
+                                  m_heightfield.slopeXRow(y), m_heightfield.slopeYRow(y), samples);
+        }
+    });
+}
 
-            zVal = m_heightMultiplier * getHeight((xVal + m_halfRes) / m_terrainSize, (yValLong + m_halfRes) / m_terrainSize);
-            topLeft = {xVal, yValLong, zVal};
+// Most chunks the mesh is split into along each side, for culling
+static constexpr int kChunksPerSide = 16;
 
-            zVal = m_heightMultiplier * getHeight((xValLong + m_halfRes) / m_terrainSize, (yValLong + m_halfRes) / m_terrainSize);
-            topRight = {xValLong, yValLong, zVal};
+// Writes the two triangles (6 indices) of the tile whose bottom-left corner is grid sample (x, y)
+void Terrain::makeTile(uint32_t *indices, int x, int y) {
+    uint32_t samples = m_heightfield.samplesPerSide();
+    uint32_t bottomLeft = y * samples + x;
+    uint32_t bottomRight = bottomLeft + 1;
+    uint32_t topLeft = bottomLeft + samples;
+    uint32_t topRight = topLeft + 1;
 
-            zVal = m_heightMultiplier * getHeight((xVal + m_halfRes) / m_terrainSize, (yVal + m_halfRes) / m_terrainSize);
-            bottomLeft = {xVal, yVal, zVal};
+    // triangle 1
+    indices[0] = topLeft;
+    indices[1] = bottomLeft;
+    indices[2] = bottomRight;
 
-            zVal = m_heightMultiplier * getHeight((xValLong + m_halfRes) / m_terrainSize, (yVal + m_halfRes) / m_terrainSize);
-            bottomRight = {xValLong, yVal, zVal};
+    // triangle 2
+    indices[3] = topLeft;
+    indices[4] = bottomRight;
+    indices[5] = topRight;
+}
 
+bool Terrain::makeFace(const CancelToken &cancel) {
+    makeHeightfield(cancel);
+    if (cancel.isCancelled()) return false;
+
+    // One shared vertex per grid sample, in the heightfield's row-major order.
+    // Every band writes its own slice of the presized buffers.
+    int samples = m_heightfield.samplesPerSide();
+    MeshWriter<MeshVertexFormat> vertices = m_mesh->resizeVertices(samples * samples);
+    parallelFor(samples, m_threads, [&](int begin, int end) {
+        for (int y = begin; y < end && !cancel.isCancelled(); y++) {
+            for (int x = 0; x < samples; x++) {
+                vertices.write(y * samples + x, m_heightfield.position(x, y), m_heightfield.normal(x, y));
+            }
+        }
+    });
+
+    // Tiles are grouped into square chunks, up to kChunksPerSide of them along each side, and each
+    // chunk's triangles are one run of the index buffer: chunk columns in turn, then the chunks up each
+    // column, then the tiles of each chunk column by column.
+    int tiles = m_heightfield.tiles();
+    int chunkTiles = (tiles + kChunksPerSide - 1) / kChunksPerSide;
+    int chunksPerSide = (tiles + chunkTiles - 1) / chunkTiles;
+    auto chunkWidth = [&](int c) { return std::min(chunkTiles, tiles - c * chunkTiles); };
+    auto tileIndex = [&](int x, int y) {
+        int cx = x / chunkTiles, cy = y / chunkTiles;
+        size_t columnStart = size_t(cx) * chunkTiles * tiles;
+        size_t chunkStart = columnStart + size_t(chunkWidth(cx)) * cy * chunkTiles;
+        return chunkStart + size_t(x - cx * chunkTiles) * chunkWidth(cy) + size_t(y - cy * chunkTiles);
+    };
+
+    // Each chunk's box spans the heights of its tiles' corners. Every band gathers the range of the
+    // chunks its columns touch and merges it in; min and max do not care about the order.
+    size_t chunks = size_t(chunksPerSide) * chunksPerSide;
+    std::vector<float> lo(chunks, INFINITY), hi(chunks, -INFINITY);
+    std::mutex boundsMutex;
+
+    std::vector<uint32_t> indices(size_t(tiles) * tiles * 6);
+    parallelFor(tiles, m_threads, [&](int begin, int end) {
+        std::vector<float> bandLo(chunks, INFINITY), bandHi(chunks, -INFINITY);
+        for (int x = begin; x < end && !cancel.isCancelled(); x++) {
+            for (int y = 0; y < tiles; y++) {
+                makeTile(&indices[tileIndex(x, y) * 6], x, y);
+
+                size_t chunk = size_t(x / chunkTiles) * chunksPerSide + y / chunkTiles;
+                for (float h : {m_heightfield.height(x, y), m_heightfield.height(x + 1, y),
+                                m_heightfield.height(x, y + 1), m_heightfield.height(x + 1, y + 1)}) {
+                    bandLo[chunk] = std::min(bandLo[chunk], h);
+                    bandHi[chunk] = std::max(bandHi[chunk], h);
+                }
+            }
+        }
 
-            makeTile(topLeft, topRight, bottomLeft, bottomRight);
+        std::lock_guard<std::mutex> lock(boundsMutex);
+        for (size_t c = 0; c < chunks; c++) {
+            lo[c] = std::min(lo[c], bandLo[c]);
+            hi[c] = std::max(hi[c], bandHi[c]);
+        }
+    });
+    if (cancel.isCancelled()) return false;
+
+    for (int cx = 0; cx < chunksPerSide; cx++) {
+        for (int cy = 0; cy < chunksPerSide; cy++) {
+            size_t chunk = size_t(cx) * chunksPerSide + cy;
+            int x0 = cx * chunkTiles, y0 = cy * chunkTiles;
+            int x1 = x0 + chunkWidth(cx), y1 = y0 + chunkWidth(cy);
+            m_mesh->chunks.addBox(int(tileIndex(x0, y0) * 6), chunkWidth(cx) * chunkWidth(cy) * 6,
+                                  glm::vec3(m_heightfield.coordinate(x0), m_heightfield.coordinate(y0), lo[chunk]),
+                                  glm::vec3(m_heightfield.coordinate(x1), m_heightfield.coordinate(y1), hi[chunk]));
         }
     }
-
-}
-
-// Inserts a glm::vec3 into a vector of floats.
-void Terrain::insertVec3(std::vector<float> &data, glm::vec3 v) {
-    data.push_back(v.x);
-    data.push_back(v.y);
-    data.push_back(v.z);
+    m_mesh->setIndices(std::move(indices));
+    return true;
 }
@@ -3,31 +3,64 @@
 #include <vector>
 #include <glm/glm.hpp>
 
+#include "noise/PerlinBatch.h"
+#include "shapes/Heightfield.h"
+#include "shapes/Mesh.h"
+#include "util/CancelToken.h"
+
 class Terrain
 {
 public:
-    void updateParams(int param1);
-    std::vector<float> generateShape() { return m_vertexData; }
+    // Regenerates the mesh. Returns false, leaving the mesh incomplete, if `cancel` fired first.
+    bool updateParams(int param1, const CancelToken &cancel = CancelToken());
+    // Samples the heightfield alone, leaving the mesh as it was, for renderers that displace on the GPU.
+    // Returns false, leaving the heightfield incomplete, if `cancel` fired first.
+    bool updateHeightfield(int param1, const CancelToken &cancel = CancelToken());
+    // Worker threads used by generation; 0 means one per hardware thread. The output does not depend on it.
+    void setThreadCount(int threads) { m_threads = threads; }
+    // Generates 1/divisor of the full resolution along each side, for quick previews
+    void setResolutionDivisor(int divisor) { m_resolutionDivisor = divisor; }
+    // Octaves of fractal noise in the height function, 4 by default
+    void setOctaves(int octaves) { m_perlin.setOctaves(octaves); }
+    // Noise kernel for the heightfield; the best the CPU supports by default, as PerlinBatch::setKernel()
+    void setKernel(PerlinBatch::Kernel kernel) { m_perlin.setKernel(kernel); }
+    // Picks the shared gradient table for `seed`; GradientTable::kDefaultSeed by default
+    void setSeed(uint32_t seed);
+    static int tileCount(int param1, int resolutionDivisor = 1);
+    // Largest param1 accepted from outside: 5000 tiles per side, 25M vertices and about 1.5 GB with
+    // the heightfield, well inside the mesh's int vertex and index counts
+    static constexpr int kMaxParam1 = 1000;
+    // The last generated mesh, shared rather than copied; later updates build a new one
+    MeshPtr generateShape() const { return m_mesh; }
+    // Hands the mesh over entirely, so it is freed as soon as the taker drops it.
+    // generateShape() returns null until the next update.
+    MeshPtr takeShape() { return std::move(m_mesh); }
+
+    // The sampled grid the current mesh was assembled from
+    const Heightfield &heightfield() const { return m_heightfield; }
 
+    // Scalar per-sample noise: the reference the batched kernels are checked and benchmarked against.
+    // Coordinates are normalized, as in Heightfield::normalized().
+    float computePerlin(float x, float y);
+    float getHeight(float x, float y);
 
 private:
-    std::vector<float> m_vertexData;
-    std::vector<glm::vec2> m_randVecLookup;
+    std::shared_ptr<Mesh> m_mesh = std::make_shared<Mesh>(); // written only until it is replaced
+    Heightfield m_heightfield;
 
     glm::vec2 sampleRandomVector(int row, int col);
 
-    int m_lookupSize;
     int m_param1;
+    int m_threads = 0;
+    int m_resolutionDivisor = 1;
+
+    // Batched SIMD evaluator over the shared gradient table, used for whole rows of samples
+    PerlinBatch m_perlin;
 
-    float computePerlin(float x, float y);
-    float getHeight(float x, float y);
     float interpolate(float A, float B, float alpha);
 
-    void insertVec3(std::vector<float> &data, glm::vec3 v);
-    void makeTile(glm::vec3 topLeft,
-                  glm::vec3 topRight,
-                  glm::vec3 bottomLeft,
-                  glm::vec3 bottomRight);
-    void makeFace();
+    void makeHeightfield(const CancelToken &cancel);
+    void makeTile(uint32_t *indices, int x, int y);
+    bool makeFace(const CancelToken &cancel);
 
 };
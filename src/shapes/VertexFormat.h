@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <glm/glm.hpp>
+
+// Compile-time description of an interleaved vertex layout.
+//
+//     using Format = VertexFormat<Attribute<float, 3>, Attribute<int8_t, 2, true>>;
+//
+// Attribute i is bound to shader location i. Offsets and the stride are computed from the component
+// types, so the generators' MeshWriter<Format> and the GL binder's attribute setup cannot disagree,
+// and a struct meant to mirror the layout can be checked against it with static_assert.
+
+enum class ComponentType { Float, Int8, UInt8, Int16, UInt16, Int32, UInt32 };
+
+template <class T>
+constexpr ComponentType componentTypeOf() {
+    if constexpr (std::is_same_v<T, float>) return ComponentType::Float;
+    else if constexpr (std::is_same_v<T, int8_t>) return ComponentType::Int8;
+    else if constexpr (std::is_same_v<T, uint8_t>) return ComponentType::UInt8;
+    else if constexpr (std::is_same_v<T, int16_t>) return ComponentType::Int16;
+    else if constexpr (std::is_same_v<T, uint16_t>) return ComponentType::UInt16;
+    else if constexpr (std::is_same_v<T, int32_t>) return ComponentType::Int32;
+    else {
+        static_assert(std::is_same_v<T, uint32_t>, "unsupported vertex component type");
+        return ComponentType::UInt32;
+    }
+}
+
+// `N` components of type `T`; integer components are read as [0, 1] / [-1, 1] if `Normalized`
+template <class T, int N, bool Normalized = false>
+struct Attribute {
+    using Component = T;
+    using Value = glm::vec<N, T, glm::defaultp>;
+    static constexpr int components = N;
+    static constexpr bool normalized = Normalized;
+    static constexpr ComponentType type = componentTypeOf<T>();
+    static constexpr size_t size = sizeof(T) * N;
+
+    static_assert(N >= 1 && N <= 4, "vertex attributes have 1 to 4 components");
+    static_assert(sizeof(Value) == size, "glm vector is not tightly packed");
+    static_assert(!Normalized || !std::is_same_v<T, float>, "only integer components can be normalized");
+};
+
+// One attribute as the GL binder needs it
+struct AttributeLayout {
+    int location;
+    int components;
+    ComponentType type;
+    bool normalized;
+    size_t offset;
+};
+
+template <class... Attributes>
+struct VertexFormat {
+    static constexpr int attributeCount = int(sizeof...(Attributes));
+    static_assert(attributeCount > 0, "a vertex format needs at least one attribute");
+
+    static constexpr std::array<size_t, sizeof...(Attributes)> sizes = {Attributes::size...};
+    static constexpr std::array<size_t, sizeof...(Attributes)> alignments = {sizeof(typename Attributes::Component)...};
+    static constexpr size_t alignment = std::max({sizeof(typename Attributes::Component)...});
+
+    // Each attribute starts at a multiple of its component size; the stride keeps the largest alignment
+    static constexpr std::array<size_t, sizeof...(Attributes)> offsets = [] {
+        std::array<size_t, sizeof...(Attributes)> result = {};
+        size_t end = 0;
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = (end + alignments[i] - 1) / alignments[i] * alignments[i];
+            end = result[i] + sizes[i];
+        }
+        return result;
+    }();
+
+    static constexpr size_t stride =
+        (offsets.back() + sizes.back() + alignment - 1) / alignment * alignment;
+
+    static constexpr std::array<AttributeLayout, sizeof...(Attributes)> layout = [] {
+        std::array<AttributeLayout, sizeof...(Attributes)> result = {};
+        int i = 0;
+        ((result[i] = {i, Attributes::components, Attributes::type, Attributes::normalized, offsets[i]}, i++), ...);
+        return result;
+    }();
+
+    template <int I>
+    using AttributeAt = std::tuple_element_t<I, std::tuple<Attributes...>>;
+};
+
+// Writes whole vertices of `Format` into presized memory: a Mesh's vertex array or a mapped GL range.
+// write() takes exactly one value per attribute, each of the attribute's own type, so a layout change
+// that the generator was not updated for does not compile.
+template <class Format>
+class MeshWriter;
+
+template <class... Attributes>
+class MeshWriter<VertexFormat<Attributes...>>
+{
+public:
+    using Format = VertexFormat<Attributes...>;
+
+    MeshWriter(void *data, int vertexCount) : m_data(static_cast<unsigned char *>(data)), m_count(vertexCount) {}
+
+    int vertexCount() const { return m_count; }
+
+    void write(int vertex, const typename Attributes::Value &...values) {
+        unsigned char *dst = m_data + size_t(vertex) * Format::stride;
+        int i = 0;
+        ((std::memcpy(dst + Format::offsets[i++], &values, Attributes::size)), ...);
+    }
+
+    // Sets only attribute `I` of `vertex`
+    template <int I>
+    void set(int vertex, const typename Format::template AttributeAt<I>::Value &value) {
+        std::memcpy(m_data + size_t(vertex) * Format::stride + Format::offsets[I], &value,
+                    Format::template AttributeAt<I>::size);
+    }
+
+private:
+    unsigned char *m_data;
+    int m_count;
+};
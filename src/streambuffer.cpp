@@ -0,0 +1,118 @@
+#include "streambuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+void StreamBuffer::create(GLenum target, GLsizeiptr capacity)
+{
+    initializeOpenGLFunctions();
+    m_target = target;
+    m_capacity = capacity;
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(m_target, m_buffer);
+    glBufferData(m_target, m_capacity, nullptr, GL_STREAM_DRAW);
+}
+
+void StreamBuffer::destroy()
+{
+    for (Claim &claim : m_claims) {
+        if (claim.fence) glDeleteSync(claim.fence);
+    }
+    m_claims.clear();
+    if (m_buffer) glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+}
+
+// Frees every claim overlapping [offset, offset + size), waiting for its fence if the GPU may still
+// be reading it. Returns false if one of them has not been retired yet, so cannot be freed at all.
+bool StreamBuffer::reclaim(GLintptr offset, GLsizeiptr size)
+{
+    auto overlaps = [&](const Claim &claim) {
+        return claim.range.offset < offset + size && offset < claim.range.offset + claim.range.size;
+    };
+    for (const Claim &claim : m_claims) {
+        if (overlaps(claim) && !claim.fence) return false;
+    }
+
+    for (auto it = m_claims.begin(); it != m_claims.end();) {
+        if (!overlaps(*it)) {
+            ++it;
+            continue;
+        }
+        // Normally long signalled: a range is only reached again after a full trip around the ring
+        GLenum status;
+        do {
+            status = glClientWaitSync(it->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(it->fence);
+        it = m_claims.erase(it);
+    }
+    return true;
+}
+
+// Orphans the storage for a larger one. Pending draws keep reading the old storage,
+// so every fence can go, but nothing written to it survives.
+void StreamBuffer::grow(GLsizeiptr size)
+{
+    for (Claim &claim : m_claims) {
+        if (claim.fence) glDeleteSync(claim.fence);
+    }
+    m_claims.clear();
+    m_capacity = std::max(m_capacity * 2, size * 2);
+    m_head = 0;
+    glBufferData(m_target, m_capacity, nullptr, GL_STREAM_DRAW);
+    m_reallocations++;
+}
+
+void *StreamBuffer::map(GLsizeiptr size, GLsizeiptr alignment, Range &range)
+{
+    if (size <= 0) return nullptr;
+
+    // Try after the newest range, then from the start of the buffer, then in fresh storage.
+    // Half the capacity at most, so a new range always fits beside the one it replaces.
+    GLintptr offset = (m_head + alignment - 1) / alignment * alignment;
+    if (size * 2 > m_capacity) {
+        grow(size);
+        offset = 0;
+    } else if (offset + size > m_capacity || !reclaim(offset, size)) {
+        offset = 0;
+        if (!reclaim(offset, size)) {
+            grow(size);
+        }
+    }
+
+    // Nothing in the range is in use any more, so the driver need neither wait nor preserve it
+    void *data = glMapBufferRange(m_target, offset, size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!data) return nullptr;
+
+    range = {offset, size};
+    m_claims.push_back({range, nullptr});
+    m_head = offset + size;
+    m_uploads++;
+    return data;
+}
+
+bool StreamBuffer::unmap()
+{
+    // False means the storage was lost (e.g. a display mode change) and the data must be written again
+    return glUnmapBuffer(m_target) == GL_TRUE;
+}
+
+bool StreamBuffer::upload(const void *data, GLsizeiptr size, GLsizeiptr alignment, Range &range)
+{
+    void *dst = map(size, alignment, range);
+    if (!dst) return false;
+    std::memcpy(dst, data, size_t(size));
+    return unmap();
+}
+
+void StreamBuffer::retire(const Range &range)
+{
+    for (Claim &claim : m_claims) {
+        if (claim.range.offset == range.offset && claim.range.size == range.size && !claim.fence) {
+            claim.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            return;
+        }
+    }
+}
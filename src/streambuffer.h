@@ -0,0 +1,66 @@
+#pragma once
+
+#include <deque>
+
+#include <QOpenGLFunctions_4_1_Core>
+
+// A GL buffer that is allocated once and streamed into, instead of being reallocated per upload.
+//
+// Uploads claim the next free range of a ring, map just that range with GL_MAP_UNSYNCHRONIZED_BIT
+// and GL_MAP_INVALIDATE_RANGE_BIT, and are written in place. Ranges that may still be read by
+// queued draws are protected by fences rather than by the driver: retire() fences a range once
+// nothing new will draw from it, and a later upload that wraps around onto it waits for that fence.
+// Only needs OpenGL 3.2 (map ranges, sync objects), so it runs on Mesa llvmpipe.
+//
+// All calls must be made on the thread that owns the GL context.
+class StreamBuffer : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    struct Range {
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;
+    };
+
+    // Creates the buffer object with `capacity` bytes of storage for `target`
+    // (GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER); the buffer is left bound.
+    void create(GLenum target, GLsizeiptr capacity);
+    void destroy();
+
+    GLuint bufferId() const { return m_buffer; }
+    GLsizeiptr capacity() const { return m_capacity; }
+
+    // Claims `size` bytes starting at a multiple of `alignment` and maps them for writing. The buffer
+    // must be bound to its target. Returns null, with nothing claimed, if the mapping fails.
+    // The range is only drawable after unmap(). If the ranges still in use leave no room, the storage
+    // is reallocated larger, which discards the contents of every earlier range.
+    void *map(GLsizeiptr size, GLsizeiptr alignment, Range &range);
+    bool unmap();
+
+    // map() + memcpy + unmap(). Returns false if the data could not be written.
+    bool upload(const void *data, GLsizeiptr size, GLsizeiptr alignment, Range &range);
+
+    // Fences `range`: draws issued so far may still read it, later ones must not.
+    // Its space is reused once the GPU has passed the fence; until then it is never overwritten.
+    void retire(const Range &range);
+
+    // Uploads and storage reallocations since create(), for diagnostics
+    int uploads() const { return m_uploads; }
+    int reallocations() const { return m_reallocations; }
+
+private:
+    struct Claim {
+        Range range;
+        GLsync fence = nullptr; // null until retired
+    };
+
+    bool reclaim(GLintptr offset, GLsizeiptr size);
+    void grow(GLsizeiptr size);
+
+    GLenum m_target = GL_ARRAY_BUFFER;
+    GLuint m_buffer = 0;
+    GLsizeiptr m_capacity = 0;
+    GLintptr m_head = 0;         // where the next range is claimed
+    std::deque<Claim> m_claims;  // ranges that may still be read, oldest first
+    int m_uploads = 0;
+    int m_reallocations = 0;
+};
@@ -0,0 +1,179 @@
+#include "streamrenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QOpenGLShaderProgram>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+
+#include "lod/ChunkBuilder.h"
+#include "vertexattributes.h"
+
+// Chunks the streamer keeps, as a multiple of the chunks within reach: room to turn back without
+// sampling again what was just left behind
+static constexpr int kCacheDiscs = 4;
+
+static const char *streamVertexShaderSource =
+    "layout(location = 0) in vec2 gridPos;\n"
+    "layout(location = 1) in vec2 heights;\n"    // ChunkVertexFormat; one level only, so just the first of each
+    "layout(location = 2) in vec4 octNormals;\n"
+    "out vec3 vert;\n"
+    "out vec3 vertNormal;\n"
+    "uniform vec3 chunkOrigin;\n"  // the chunk's low corner relative to the ground below the camera
+    "uniform float quadSize;\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform mat4 mvMatrix;\n"
+    "uniform mat3 normalMatrix;\n"
+    "void main() {\n"
+    "   vec4 position = vec4(chunkOrigin + vec3(gridPos * quadSize, heights.x), 1.0);\n"
+    "   vert = vec3(mvMatrix * position);\n"
+    "   vertNormal = normalMatrix * octDecode(octNormals.xy);\n"
+    "   gl_Position = projMatrix * mvMatrix * position;\n"
+    "}\n";
+
+void StreamRenderer::create()
+{
+    initializeOpenGLFunctions();
+
+    m_program = new QOpenGLShaderProgram;
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, glslSource({octDecodeSource, streamVertexShaderSource}).c_str());
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, glslSource({shadeSource, pointLitFragmentSource}).c_str());
+    m_program->link();
+    m_program->bind();
+    m_program->setUniformValue("lightPos", QVector3D(70, 70, 70));
+    m_program->release();
+
+    // Every chunk whose nearest point can lie within kRadius chunk sides, nearest first
+    m_offsets.clear();
+    for (int y = -kRadius - 1; y <= kRadius; y++) {
+        for (int x = -kRadius - 1; x <= kRadius; x++) {
+            glm::vec2 nearest = glm::max(glm::vec2(0.f), glm::max(glm::vec2(x, y), -glm::vec2(x + 1, y + 1)));
+            if (glm::length(nearest) < kRadius) m_offsets.emplace_back(x, y);
+        }
+    }
+    std::stable_sort(m_offsets.begin(), m_offsets.end(), [](const glm::ivec2 &a, const glm::ivec2 &b) {
+        glm::vec2 ca = glm::vec2(a) + 0.5f, cb = glm::vec2(b) + 0.5f;
+        return glm::dot(ca, ca) < glm::dot(cb, cb);
+    });
+
+    // Shared chunk indices, each tile split along the same diagonal as Terrain's
+    int side = kGridSize + 1;
+    std::vector<uint16_t> indices;
+    for (int y = 0; y < kGridSize; y++) {
+        for (int x = 0; x < kGridSize; x++) {
+            uint16_t bottomLeft = uint16_t(y * side + x), bottomRight = bottomLeft + 1;
+            uint16_t topLeft = bottomLeft + side, topRight = topLeft + 1;
+            indices.insert(indices.end(), {topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight});
+        }
+    }
+    m_indexCount = GLsizei(indices.size());
+
+    m_vao.create();
+    m_vao.bind();
+    glGenBuffers(1, &m_indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indices.size() * sizeof(uint16_t)), indices.data(), GL_STATIC_DRAW);
+
+    // One slot per chunk within reach: a frame never uses more, so the pool never grows
+    m_pool.create(GLsizeiptr(ChunkBuilder::vertexCount(kGridSize) * ChunkVertexFormat::stride), int(m_offsets.size()),
+                  &setVertexAttributes<ChunkVertexFormat>);
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StreamRenderer::destroy()
+{
+    m_streamer.reset();
+    m_threads = -1;
+    delete m_program;
+    m_program = nullptr;
+    m_pool.destroy();
+    glDeleteBuffers(1, &m_indexBuffer);
+    m_indexBuffer = 0;
+    m_vao.destroy();
+}
+
+void StreamRenderer::configure(int octaves, int threads, const std::function<void()> &chunkReady)
+{
+    if (m_streamer && threads == m_threads && octaves == m_streamer->octaves()) return;
+    if (!m_streamer || threads != m_threads) {
+        m_streamer = std::make_unique<ChunkStreamer>(kGridSize, kQuadSize, kCacheDiscs * m_offsets.size(), threads,
+                                                     chunkReady);
+        m_threads = threads;
+    }
+    m_streamer->setOctaves(octaves);
+    m_ground.setOctaves(octaves);
+    m_pool.clear();
+}
+
+double StreamRenderer::reach() const
+{
+    return kRadius * kGridSize * kQuadSize;
+}
+
+void StreamRenderer::render(const glm::mat4 &proj, const glm::mat4 &modelView, const glm::dvec2 &center, bool wireframe)
+{
+    m_streamer->beginFrame();
+    m_pool.beginFrame();
+
+    double chunkSize = m_streamer->chunkSize();
+    glm::ivec2 centerChunk(int(std::floor(center.x / chunkSize)), int(std::floor(center.y / chunkSize)));
+
+    m_vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, m_pool.bufferId());
+
+    // Chunks already on the GPU are drawn without asking the streamer, so its cache only holds on to
+    // what was recently left behind. They are all marked used first, so none is evicted for a new one.
+    m_visible.clear();
+    for (const glm::ivec2 &offset : m_offsets) {
+        glm::ivec2 chunk = centerChunk + offset;
+        m_visible.push_back({chunk, m_pool.find(chunkKey(chunk.x, chunk.y))});
+    }
+    size_t drawn = 0;
+    for (const Visible &visible : m_visible) {
+        int slot = visible.slot;
+        if (slot < 0) {
+            ChunkDataPtr data = m_streamer->request(visible.chunk.x, visible.chunk.y);
+            if (!data) continue;
+            slot = m_pool.insert(chunkKey(visible.chunk.x, visible.chunk.y));
+            m_pool.upload(slot, data->data());
+        }
+        m_visible[drawn++] = {visible.chunk, slot};
+    }
+    m_visible.resize(drawn);
+
+    // As in ChunkBuilder: Terrain's noise at (world + 5) / 10, scaled by 10
+    float ground = ChunkBuilder::kHeightScale * m_ground.getHeight(ChunkBuilder::noiseCoordinate(center.x),
+                                                                   ChunkBuilder::noiseCoordinate(center.y));
+
+    m_program->bind();
+    m_program->setUniformValue("projMatrix", toQMatrix(proj));
+    m_program->setUniformValue("mvMatrix", toQMatrix(modelView));
+    m_program->setUniformValue("normalMatrix", toQMatrix(modelView).normalMatrix());
+    m_program->setUniformValue("quadSize", float(kQuadSize));
+
+    GLint vertices = ChunkBuilder::vertexCount(kGridSize);
+    int passes = wireframe ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        bool lines = pass == 1;
+        m_program->setUniformValue("wireframe", lines);
+        glPolygonMode(GL_FRONT_AND_BACK, lines ? GL_LINE : GL_FILL);
+        if (lines) {
+            glEnable(GL_POLYGON_OFFSET_LINE);
+            glPolygonOffset(-1, -1);
+        }
+        for (const Visible &visible : m_visible) {
+            // The offset is formed in double, so it stays exact however far the camera has travelled
+            glm::dvec2 origin = m_streamer->chunkOrigin(visible.chunk.x, visible.chunk.y) - center;
+            m_program->setUniformValue("chunkOrigin", QVector3D(float(origin.x), float(origin.y), -ground));
+            glDrawElementsBaseVertex(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_SHORT, nullptr, visible.slot * vertices);
+        }
+    }
+    glDisable(GL_POLYGON_OFFSET_LINE);
+    glPolygonOffset(0, 0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    m_program->release();
+    m_vao.release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
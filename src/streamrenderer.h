@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLVertexArrayObject>
+
+#include "chunkpool.h"
+#include "lod/ChunkStreamer.h"
+#include "shapes/Terrain.h"
+
+QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
+
+// Draws the unbounded terrain as equal chunks streamed in around a camera that travels over it.
+//
+// Every frame asks a ChunkStreamer for the chunks within kRadius chunks of the camera, nearest first,
+// and draws those it has; the others fill in over the next frames as the workers finish them. Drawn
+// chunks keep their vertices in a ChunkPool sized for the disc, so neither the GPU's copy nor the
+// streamer's cache grows with the distance travelled. Chunks are placed relative to the ground below
+// the camera, so precision does not drop far from the origin.
+// Needs a current GL context throughout.
+class StreamRenderer : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    static constexpr int kGridSize = 16;
+    static constexpr double kQuadSize = 0.125;
+    // Chunks are drawn out to this many chunk sides from the camera
+    static constexpr int kRadius = 12;
+
+    void create();
+    void destroy();
+
+    // `octaves` of noise, sampled by `threads` workers (0 means one per hardware thread); any change
+    // drops every chunk. `chunkReady` is called on a worker thread whenever a chunk can be drawn.
+    void configure(int octaves, int threads, const std::function<void()> &chunkReady);
+    const ChunkStreamer *streamer() const { return m_streamer.get(); }
+    // Distance to the farthest chunk drawn
+    double reach() const;
+
+    // `modelView` maps terrain coordinates relative to the ground below `center` (z up) to the eye
+    void render(const glm::mat4 &proj, const glm::mat4 &modelView, const glm::dvec2 &center, bool wireframe);
+
+private:
+    struct Visible
+    {
+        glm::ivec2 chunk;
+        int slot;
+    };
+
+    static uint64_t chunkKey(int x, int y) { return uint64_t(uint32_t(x)) << 32 | uint32_t(y); }
+
+    std::unique_ptr<ChunkStreamer> m_streamer;
+    int m_threads = -1;
+    Terrain m_ground; // samples the height below the camera
+
+    QOpenGLShaderProgram *m_program = nullptr;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_indexBuffer = 0;
+    GLsizei m_indexCount = 0;
+    ChunkPool m_pool;
+
+    std::vector<glm::ivec2> m_offsets; // chunk offsets within the disc, nearest first
+    std::vector<Visible> m_visible;
+};
@@ -13,38 +13,21 @@ TerrainGenerator::TerrainGenerator()
   // Define resolution of terrain generation
   m_resolution = 100;
 
-  // Generate random vector lookup table
-  m_lookupSize = 1024;
-  m_randVecLookup.reserve(m_lookupSize);
-
-  // Initialize random number generator
-  std::srand(1230);
-
-  // Populate random vector lookup table
-  for (int i = 0; i < m_lookupSize; i++)
-  {
-    m_randVecLookup.push_back(glm::vec2(std::rand() * 2.0 / RAND_MAX - 1.0,
-                                        std::rand() * 2.0 / RAND_MAX - 1.0));
-    }
+  // Random vector lookup table: the same shared, read-only table Terrain uses
+  m_perlin.setTable(GradientTable::forSeed(GradientTable::kDefaultSeed));
 }
 
 // Destructor
 TerrainGenerator::~TerrainGenerator()
 {
-    m_randVecLookup.clear();
-}
-
-// Helper for generateTerrain()
-void addPointToVector(glm::vec3 point, std::vector<float>& vector) {
-    vector.push_back(point.x);
-    vector.push_back(point.y);
-    vector.push_back(point.z);
 }
 
 // Generates the geometry of the output triangle mesh
 std::vector<float> TerrainGenerator::generateTerrain() {
-    std::vector<float> verts;
-    verts.reserve(m_resolution * m_resolution * 6);
+    // Two triangles per tile, written in place into the exactly presized soup
+    std::vector<float> verts(size_t(m_resolution) * m_resolution * 6 * ColoredVertexFormat::stride / sizeof(float));
+    MeshWriter<ColoredVertexFormat> writer(verts.data(), m_resolution * m_resolution * 6);
+    int v = 0;
 
     for(int x = 0; x < m_resolution; x++) {
         for(int y = 0; y < m_resolution; y++) {
@@ -68,33 +51,17 @@ std::vector<float> TerrainGenerator::generateTerrain() {
             // x1y1z1
             // x2y1z2
             // x2y2z3
-            addPointToVector(p1, verts);
-            addPointToVector(n1, verts);
-            addPointToVector(getColor(n1, p1), verts);
-
-            addPointToVector(p2, verts);
-            addPointToVector(n2, verts);
-            addPointToVector(getColor(n2, p2), verts);
-
-            addPointToVector(p3, verts);
-            addPointToVector(n3, verts);
-            addPointToVector(getColor(n3, p3), verts);
+            writer.write(v++, p1, n1, getColor(n1, p1));
+            writer.write(v++, p2, n2, getColor(n2, p2));
+            writer.write(v++, p3, n3, getColor(n3, p3));
 
             // tris 2
             // x1y1z1
             // x2y2z3
             // x1y2z4
-            addPointToVector(p1, verts);
-            addPointToVector(n1, verts);
-            addPointToVector(getColor(n1, p1), verts);
-
-            addPointToVector(p3, verts);
-            addPointToVector(n3, verts);
-            addPointToVector(getColor(n3, p3), verts);
-
-            addPointToVector(p4, verts);
-            addPointToVector(n4, verts);
-            addPointToVector(getColor(n4, p4), verts);
+            writer.write(v++, p1, n1, getColor(n1, p1));
+            writer.write(v++, p3, n3, getColor(n3, p3));
+            writer.write(v++, p4, n4, getColor(n4, p4));
         }
     }
     return verts;
@@ -103,9 +70,7 @@ std::vector<float> TerrainGenerator::generateTerrain() {
 // Samples the (infinite) random vector grid at (row, col)
 glm::vec2 TerrainGenerator::sampleRandomVector(int row, int col)
 {
-    std::hash<int> intHash;
-    int index = intHash(row * 41 + col * 43) % m_lookupSize;
-    return m_randVecLookup.at(index);
+    return m_perlin.table().gradient(row, col);
 }
 
 // Takes a grid coordinate (row, col), [0, m_resolution), which describes a vertex in a plane mesh
@@ -137,45 +102,24 @@ float TerrainGenerator::getHeight(float x, float y) {
     //float z = computePerlin(x * 8, y * 8) / 8;
     float z = 0;
 
-    // Task 7: combine multiple different octaves of noise to produce fractal perlin noise
-    z += computePerlin(x * 8, y * 8) / 8;
-    z += computePerlin(x * 16, y * 16) / 16;
-    z += computePerlin(x * 32, y * 32) / 32;
-    z += computePerlin(x * 64, y * 64) / 64;
+    // Task 7: combine multiple different octaves of noise to produce fractal perlin noise.
+    // The octaves (x8, x16, x32, x64) are unrolled at compile time inside m_perlin's kernel
+    m_perlin.getHeight(&x, &y, &z, 1);
 
-    // Return 0 as placeholder
     return z;
 }
 
-// Computes the normal of a vertex by averaging neighbors
+// Computes the normal of a vertex from the analytic slope of getHeight()
 glm::vec3 TerrainGenerator::getNormal(int row, int col) {
-    // Task 9: Compute the average normal for the given input indices
-    glm::vec3 Vpos = getPosition(row, col);
-
-    glm::vec2 n0 = {row - 1, col - 1};
-    glm::vec2 n1 = {row, col - 1};
-    glm::vec2 n2 = {row + 1, col - 1};
-    glm::vec2 n3 = {row + 1, col};
-    glm::vec2 n4 = {row + 1, col + 1};
-    glm::vec2 n5 = {row, col + 1};
-    glm::vec2 n6 = {row - 1, col + 1};
-    glm::vec2 n7 = {row - 1, col};
-
-    std::vector nS = {n0, n1, n2, n3, n4, n5, n6, n7};
-    glm::vec3 normalS = {0, 0, 0};
-
-    for (int i = 0; i < 8; i++) {
-        glm::vec3 Vni = getPosition(nS[i][0], nS[i][1]) - Vpos;
-        glm::vec3 VniPlus1 = getPosition(nS[i + 1][0], nS[i + 1][1]) - Vpos;
-        glm::vec3 normal = glm::cross(Vni, VniPlus1);
-        normalS += glm::normalize(normal);
-    }
-
-    normalS = glm::normalize(normalS);
+    // Task 9: Compute the normal for the given input indices.
+    // The noise evaluator returns the height's partial derivatives in the same pass as the height,
+    // so no neighbouring positions are needed.
+    float x = 1.0 * row / m_resolution;
+    float y = 1.0 * col / m_resolution;
+    float z, dzdx, dzdy;
+    m_perlin.getHeightAndGradient(&x, &y, &z, &dzdx, &dzdy, 1);
 
-    // Return up as placeholder
-    return normalS;
-//    return glm::vec3(0,0,1);
+    return glm::normalize(glm::vec3(-dzdx, -dzdy, 1));
 }
 
 // Computes color of vertex using normal and, optionally, position
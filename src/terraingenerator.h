@@ -2,6 +2,11 @@
 
 #include <vector>
 #include "glm/glm.hpp"
+#include "noise/PerlinBatch.h"
+#include "shapes/VertexFormat.h"
+
+// generateTerrain()'s triangle soup: position, normal, color
+using ColoredVertexFormat = VertexFormat<Attribute<float, 3>, Attribute<float, 3>, Attribute<float, 3>>;
 
 class TerrainGenerator
 {
@@ -11,14 +16,16 @@ public:
     TerrainGenerator();
     ~TerrainGenerator();
     int getResolution() { return m_resolution; };
+    void setResolution(int resolution) { m_resolution = resolution; }
     std::vector<float> generateTerrain();
 
 private:
 
     // Member variables for terrain generation. You will not need to use these directly.
-    std::vector<glm::vec2> m_randVecLookup;
     int m_resolution;
-    int m_lookupSize;
+
+    // Batched evaluator over the shared gradient table, also used for analytic normals
+    PerlinBatch m_perlin;
 
     // Samples the (infinite) random vector grid at (row, col)
     glm::vec2 sampleRandomVector(int row, int col);
@@ -33,7 +40,7 @@ private:
     // Returns a height value, z, by sampling a noise function
     float getHeight(float x, float y);
 
-    // Computes the normal of a vertex by averaging neighbors
+    // Computes the normal of a vertex from the analytic slope of getHeight()
     glm::vec3 getNormal(int row, int col);
 
     // Computes color of vertex using normal and, optionally, position
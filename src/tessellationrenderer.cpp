@@ -0,0 +1,437 @@
+#include "tessellationrenderer.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QOpenGLShaderProgram>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+
+#include "noise/GradientTable.h"
+#include "noise/PerlinKernels.h"
+#include "vertexattributes.h"
+
+// Largest on-screen length of a tessellated edge segment, in pixels
+static constexpr float kPixelError = 8.f;
+// Terrain::makeHeightfield()'s extent and height scale
+static constexpr float kTerrainSize = 10.f;
+static constexpr float kTerrainOrigin = -kTerrainSize / 2;
+static constexpr float kTerrainHeightScale = kTerrainSize;
+
+static const char *versionSource = "#version 410 core\n";
+
+// The CPU's noise, reading GradientTable from a 512-texel texture: the permutation in red and, for
+// the first 256 texels, the 2D gradients in green and blue. Both return the value and its gradient.
+static const char *noiseSource =
+    "uniform sampler1D gradients;\n"
+    "int perm(int i) { return int(texelFetch(gradients, i, 0).r); }\n"
+    "vec2 gradient2(int x, int y) { return texelFetch(gradients, perm(perm(x & 255) + (y & 255)), 0).gb; }\n"
+    // Terrain::computePerlin()
+    "vec3 perlin2(vec2 p) {\n"
+    "   vec2 i = floor(p), f = p - i;\n"
+    "   int X = int(i.x), Y = int(i.y);\n"
+    "   vec2 g00 = gradient2(X, Y), g10 = gradient2(X + 1, Y);\n"
+    "   vec2 g01 = gradient2(X, Y + 1), g11 = gradient2(X + 1, Y + 1);\n"
+    "   float n00 = dot(g00, f), n10 = dot(g10, f - vec2(1.0, 0.0));\n"
+    "   float n01 = dot(g01, f - vec2(0.0, 1.0)), n11 = dot(g11, f - 1.0);\n"
+    "   vec2 u = f * f * (3.0 - 2.0 * f), du = 6.0 * f * (1.0 - f);\n"
+    "   float k = n00 - n10 - n01 + n11;\n"
+    "   float value = n00 + u.x * (n10 - n00) + u.y * (n01 - n00) + u.x * u.y * k;\n"
+    "   vec2 slope = g00 + u.x * (g10 - g00) + u.y * (g01 - g00) + u.x * u.y * (g00 - g10 - g01 + g11)\n"
+    "              + du * vec2(n10 - n00 + u.y * k, n01 - n00 + u.x * k);\n"
+    "   return vec3(value, slope);\n"
+    "}\n"
+    "vec3 fbm2(vec2 p, int octaves) {\n"
+    "   vec3 sum = vec3(0.0);\n"
+    "   float frequency = FBM_FREQUENCY, amplitude = FBM_AMPLITUDE;\n"
+    "   for (int o = 0; o < octaves; o++) {\n"
+    "       sum += amplitude * perlin2(p * frequency) * vec3(1.0, frequency, frequency);\n"
+    "       frequency *= FBM_LACUNARITY;\n"
+    "       amplitude *= FBM_GAIN;\n"
+    "   }\n"
+    "   return sum;\n"
+    "}\n"
+    // Perlin3D::noise()
+    "const vec3 kGradients3[16] = vec3[16](\n"
+    "   vec3(1, 1, 0), vec3(-1, 1, 0), vec3(1, -1, 0), vec3(-1, -1, 0),\n"
+    "   vec3(1, 0, 1), vec3(-1, 0, 1), vec3(1, 0, -1), vec3(-1, 0, -1),\n"
+    "   vec3(0, 1, 1), vec3(0, -1, 1), vec3(0, 1, -1), vec3(0, -1, -1),\n"
+    "   vec3(1, 1, 0), vec3(-1, 1, 0), vec3(0, -1, 1), vec3(0, -1, -1));\n"
+    "vec4 perlin3(vec3 p) {\n"
+    "   vec3 i = floor(p), f = p - i;\n"
+    "   ivec3 P = ivec3(mod(i, 256.0)) & 255;\n"
+    "   vec3 u = f * f * (3.0 - 2.0 * f), du = 6.0 * f * (1.0 - f);\n"
+    "   vec4 sum = vec4(0.0);\n"
+    "   for (int c = 0; c < 8; c++) {\n"
+    "       ivec3 d = ivec3(c & 1, (c >> 1) & 1, c >> 2);\n"
+    "       vec3 g = kGradients3[perm(perm(perm(P.x + d.x) + P.y + d.y) + P.z + d.z) & 15];\n"
+    "       float n = dot(g, f - vec3(d));\n"
+    "       vec3 w = mix(1.0 - u, u, vec3(d)), dw = mix(-du, du, vec3(d));\n"
+    "       float weight = w.x * w.y * w.z;\n"
+    "       sum += vec4(weight * n, weight * g + n * vec3(dw.x * w.y * w.z, w.x * dw.y * w.z, w.x * w.y * dw.z));\n"
+    "   }\n"
+    "   return sum;\n"
+    "}\n"
+    "vec4 fbm3(vec3 p, int octaves) {\n"
+    "   vec4 sum = vec4(0.0);\n"
+    "   float frequency = FBM_FREQUENCY, amplitude = FBM_AMPLITUDE;\n"
+    "   for (int o = 0; o < octaves; o++) {\n"
+    "       sum += amplitude * perlin3(p * frequency) * vec4(1.0, vec3(frequency));\n"
+    "       frequency *= FBM_LACUNARITY;\n"
+    "       amplitude *= FBM_GAIN;\n"
+    "   }\n"
+    "   return sum;\n"
+    "}\n";
+
+// Shared by both control shaders: the level of an edge between eye-space points a and b, from its
+// size on screen seen as a sphere around it. It depends on nothing but the two points, so the two
+// patches that share an edge always agree on it.
+static const char *edgeLevelSource =
+    "uniform float pixelsPerUnit;\n"
+    "uniform float pixelError;\n"
+    "uniform float maxLevel;\n"
+    "float edgeLevel(vec3 a, vec3 b) {\n"
+    "   float pixels = distance(a, b) * pixelsPerUnit / max(length(a + b) * 0.5, 1e-12);\n"
+    "   return clamp(pixels / pixelError, 1.0, maxLevel);\n"
+    "}\n"
+    // True when every point lies outside one frustum plane
+    "bool outsideFrustum(vec4 clip[8]) {\n"
+    "   for (int axis = 0; axis < 3; axis++) {\n"
+    "       bool below = true, above = true;\n"
+    "       for (int i = 0; i < 8; i++) {\n"
+    "           below = below && clip[i][axis] < -clip[i].w;\n"
+    "           above = above && clip[i][axis] > clip[i].w;\n"
+    "       }\n"
+    "       if (below || above) return true;\n"
+    "   }\n"
+    "   return false;\n"
+    "}\n"
+    // Corners 0-3 are (0, 0), (1, 0), (1, 1), (0, 1) in the patch's (u, v); outer level k is edge
+    // u = 0, v = 0, u = 1, v = 1 in turn
+    "void setLevels(vec3 eye[4], bool culled) {\n"
+    "   if (culled) {\n"
+    "       gl_TessLevelOuter[0] = gl_TessLevelOuter[1] = gl_TessLevelOuter[2] = gl_TessLevelOuter[3] = 0.0;\n"
+    "       return;\n"
+    "   }\n"
+    "   gl_TessLevelOuter[0] = edgeLevel(eye[0], eye[3]);\n"
+    "   gl_TessLevelOuter[1] = edgeLevel(eye[0], eye[1]);\n"
+    "   gl_TessLevelOuter[2] = edgeLevel(eye[1], eye[2]);\n"
+    "   gl_TessLevelOuter[3] = edgeLevel(eye[3], eye[2]);\n"
+    "   gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);\n"
+    "   gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);\n"
+    "}\n";
+
+static const char *terrainVertexShaderSource =
+    "layout(location = 0) in vec2 corner;\n"
+    "out vec2 vCorner;\n"
+    "void main() { vCorner = corner; }\n";
+static const char *terrainControlShaderSource =
+    "layout(vertices = 4) out;\n"
+    "in vec2 vCorner[];\n"
+    "out vec2 tcCorner[];\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform mat4 mvMatrix;\n"
+    "uniform float heightBound;\n"  // no height exceeds it in magnitude
+    "void main() {\n"
+    "   tcCorner[gl_InvocationID] = vCorner[gl_InvocationID];\n"
+    "   if (gl_InvocationID != 0) return;\n"
+    "   vec3 eye[4];\n"
+    "   vec4 clip[8];\n"
+    "   for (int i = 0; i < 4; i++) {\n"
+    "       eye[i] = vec3(mvMatrix * vec4(vCorner[i], 0.0, 1.0));\n"
+    "       clip[2 * i] = projMatrix * mvMatrix * vec4(vCorner[i], -heightBound, 1.0);\n"
+    "       clip[2 * i + 1] = projMatrix * mvMatrix * vec4(vCorner[i], heightBound, 1.0);\n"
+    "   }\n"
+    "   setLevels(eye, outsideFrustum(clip));\n"
+    "}\n";
+static const char *terrainEvaluationShaderSource =
+    "layout(quads, fractional_even_spacing, ccw) in;\n"
+    "in vec2 tcCorner[];\n"
+    "out vec3 vert;\n"
+    "out vec3 vertNormal;\n"
+    "uniform float origin;\n"       // the terrain covers [origin, origin + size] on both axes
+    "uniform float size;\n"
+    "uniform float heightScale;\n"
+    "uniform int octaves;\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform mat4 mvMatrix;\n"
+    "uniform mat3 normalMatrix;\n"
+    "void main() {\n"
+    "   vec2 xy = mix(tcCorner[0], tcCorner[2], gl_TessCoord.xy);\n"
+    "   vec3 height = fbm2((xy - origin) / size, octaves);\n"
+    "   vec3 normal = normalize(vec3(-heightScale / size * height.yz, 1.0));\n"
+    "   vert = vec3(mvMatrix * vec4(xy, heightScale * height.x, 1.0));\n"
+    "   vertNormal = normalMatrix * normal;\n"
+    "   gl_Position = projMatrix * vec4(vert, 1.0);\n"
+    "}\n";
+
+// CubeSphere.cpp in double precision
+static const char *cubeSphereSource =
+    "const dvec3 kFaceAxes[18] = dvec3[18](\n"
+    "   dvec3(1, 0, 0), dvec3(0, 1, 0), dvec3(0, 0, 1),  dvec3(-1, 0, 0), dvec3(0, 0, 1), dvec3(0, 1, 0),\n"
+    "   dvec3(0, 1, 0), dvec3(0, 0, 1), dvec3(1, 0, 0),  dvec3(0, -1, 0), dvec3(1, 0, 0), dvec3(0, 0, 1),\n"
+    "   dvec3(0, 0, 1), dvec3(1, 0, 0), dvec3(0, 1, 0),  dvec3(0, 0, -1), dvec3(0, 1, 0), dvec3(1, 0, 0));\n"
+    "dvec3 cubeSphereDirection(int face, dvec2 uv) {\n"
+    "   dvec3 c = kFaceAxes[3 * face] + uv.x * kFaceAxes[3 * face + 1] + uv.y * kFaceAxes[3 * face + 2];\n"
+    "   dvec3 s = c * c;\n"
+    "   return dvec3(c.x * sqrt(1.0 - s.y / 2.0 - s.z / 2.0 + s.y * s.z / 3.0),\n"
+    "                c.y * sqrt(1.0 - s.z / 2.0 - s.x / 2.0 + s.z * s.x / 3.0),\n"
+    "                c.z * sqrt(1.0 - s.x / 2.0 - s.y / 2.0 + s.x * s.y / 3.0));\n"
+    "}\n"
+    "uniform dvec3 camera;\n"       // in planet coordinates
+    "uniform mat3 viewRotation;\n"  // planet to eye, without the translation
+    "vec3 toEye(dvec3 position) { return viewRotation * vec3(position - camera); }\n";
+
+static const char *planetVertexShaderSource =
+    "layout(location = 0) in vec3 corner;\n" // (face, u, v)
+    "out vec3 vCorner;\n"
+    "void main() { vCorner = corner; }\n";
+static const char *planetControlShaderSource =
+    "layout(vertices = 4) out;\n"
+    "in vec3 vCorner[];\n"
+    "out vec3 tcCorner[];\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform double radius;\n"
+    "uniform float minRadius;\n"    // surface radius bounds, relative to radius
+    "uniform float maxRadius;\n"
+    "void main() {\n"
+    "   tcCorner[gl_InvocationID] = vCorner[gl_InvocationID];\n"
+    "   if (gl_InvocationID != 0) return;\n"
+    "   int face = int(vCorner[0].x);\n"
+    "   vec3 center = vec3(cubeSphereDirection(face, dvec2(vCorner[0].yz + vCorner[2].yz) / 2.0));\n"
+    "   dvec3 corners[4];\n"
+    "   float spread = 0.0;\n"          // widest angle from the center to the patch's edge
+    "   for (int i = 0; i < 4; i++) {\n"
+    "       corners[i] = cubeSphereDirection(face, dvec2(vCorner[i].yz));\n"
+    "       spread = max(spread, acos(clamp(dot(center, vec3(corners[i])), -1.0, 1.0)));\n"
+    "   }\n"
+    // Behind the horizon: even the highest point is farther around from the camera than the
+    // camera's horizon and the point's own horizon over the lowest ground together
+    "   float cameraRadius = float(length(camera) / radius);\n"
+    "   float around = acos(clamp(dot(center, vec3(normalize(camera))), -1.0, 1.0)) - spread;\n"
+    "   bool culled = cameraRadius > minRadius &&\n"
+    "       around > acos(minRadius / cameraRadius) + acos(minRadius / maxRadius);\n"
+    "   vec3 eye[4];\n"
+    "   vec4 clip[8];\n"
+    "   float bulge = maxRadius / cos(spread);\n" // the patch's surface bows outward between corners
+    "   for (int i = 0; i < 4; i++) {\n"
+    "       eye[i] = toEye(corners[i] * radius);\n"
+    "       clip[2 * i] = projMatrix * vec4(toEye(corners[i] * (radius * minRadius)), 1.0);\n"
+    "       clip[2 * i + 1] = projMatrix * vec4(toEye(corners[i] * (radius * bulge)), 1.0);\n"
+    "   }\n"
+    "   setLevels(eye, culled || outsideFrustum(clip));\n"
+    "}\n";
+static const char *planetEvaluationShaderSource =
+    "layout(quads, fractional_even_spacing, ccw) in;\n"
+    "in vec3 tcCorner[];\n"
+    "out vec3 vertNormal;\n"
+    "uniform mat4 projMatrix;\n"
+    "uniform double radius;\n"
+    "uniform float heightScale;\n"
+    "uniform int octaves;\n"
+    "void main() {\n"
+    "   dvec2 uv = mix(dvec2(tcCorner[0].yz), dvec2(tcCorner[2].yz), dvec2(gl_TessCoord.xy));\n"
+    "   dvec3 direction = cubeSphereDirection(int(tcCorner[0].x), uv);\n"
+    "   vec3 d = vec3(direction);\n"
+    "   vec4 height = fbm3(d, octaves);\n"
+    // The surface normal tilts against the height's gradient along the sphere
+    "   vec3 tangential = height.yzw - dot(height.yzw, d) * d;\n"
+    "   vec3 normal = normalize(d - heightScale / (1.0 + heightScale * height.x) * tangential);\n"
+    "   vertNormal = viewRotation * normal;\n"
+    "   gl_Position = projMatrix * vec4(toEye(direction * (radius * (1.0 + heightScale * height.x))), 1.0);\n"
+    "}\n";
+
+// The fBm constants, spelled out for the shaders
+static std::string fbmDefines()
+{
+    return "#define FBM_FREQUENCY " + std::to_string(DefaultFbm::baseFrequency) + "\n" +
+           "#define FBM_AMPLITUDE " + std::to_string(DefaultFbm::baseAmplitude) + "\n" +
+           "#define FBM_LACUNARITY " + std::to_string(DefaultFbm::lacunarity) + "\n" +
+           "#define FBM_GAIN " + std::to_string(DefaultFbm::gain) + "\n";
+}
+
+static QOpenGLShaderProgram *makeProgram(std::initializer_list<std::pair<QOpenGLShader::ShaderType, std::string>> stages)
+{
+    auto *program = new QOpenGLShaderProgram;
+    for (const auto &stage : stages) {
+        program->addShaderFromSourceCode(stage.first, (versionSource + stage.second).c_str());
+    }
+    program->link();
+    return program;
+}
+
+void TessellationRenderer::create()
+{
+    initializeOpenGLFunctions();
+
+    std::string noise = fbmDefines() + noiseSource;
+    m_terrainProgram = makeProgram({
+        {QOpenGLShader::Vertex, terrainVertexShaderSource},
+        {QOpenGLShader::TessellationControl, std::string(edgeLevelSource) + terrainControlShaderSource},
+        {QOpenGLShader::TessellationEvaluation, noise + terrainEvaluationShaderSource},
+        {QOpenGLShader::Fragment, std::string(shadeSource) + pointLitFragmentSource},
+    });
+    m_planetProgram = makeProgram({
+        {QOpenGLShader::Vertex, planetVertexShaderSource},
+        {QOpenGLShader::TessellationControl, std::string(cubeSphereSource) + edgeLevelSource + planetControlShaderSource},
+        {QOpenGLShader::TessellationEvaluation, cubeSphereSource + noise + planetEvaluationShaderSource},
+        {QOpenGLShader::Fragment, std::string(shadeSource) + sunLitFragmentSource},
+    });
+    for (QOpenGLShaderProgram *program : {m_terrainProgram, m_planetProgram}) {
+        program->bind();
+        program->setUniformValue("gradients", 0);
+        program->setUniformValue("pixelError", kPixelError);
+        program->release();
+    }
+
+    // Patch corners, four per patch in the control shaders' order
+    std::vector<glm::vec2> terrain;
+    float side = kTerrainSize / kTerrainPatches;
+    for (int y = 0; y < kTerrainPatches; y++) {
+        for (int x = 0; x < kTerrainPatches; x++) {
+            glm::vec2 corner = glm::vec2(kTerrainOrigin) + side * glm::vec2(x, y);
+            terrain.insert(terrain.end(), {corner, corner + glm::vec2(side, 0), corner + side, corner + glm::vec2(0, side)});
+        }
+    }
+    // Face coordinates are exact dyadic fractions, so patches on either side of a cube edge meet exactly
+    std::vector<glm::vec3> planet;
+    float step = 2.f / kPlanetPatches;
+    for (int face = 0; face < kCubeFaces; face++) {
+        for (int y = 0; y < kPlanetPatches; y++) {
+            for (int x = 0; x < kPlanetPatches; x++) {
+                float u = -1 + x * step, v = -1 + y * step, f = float(face);
+                planet.insert(planet.end(), {{f, u, v}, {f, u + step, v}, {f, u + step, v + step}, {f, u, v + step}});
+            }
+        }
+    }
+
+    auto makePatches = [this](QOpenGLVertexArrayObject &vao, GLuint &buffer, const void *data, size_t bytes, int components) {
+        vao.create();
+        vao.bind();
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(bytes), data, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, components, GL_FLOAT, GL_FALSE, 0, nullptr);
+        vao.release();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    };
+    makePatches(m_terrainVao, m_terrainBuffer, terrain.data(), terrain.size() * sizeof(glm::vec2), 2);
+    makePatches(m_planetVao, m_planetBuffer, planet.data(), planet.size() * sizeof(glm::vec3), 3);
+
+    const GradientTable &table = *GradientTable::forSeed(GradientTable::kDefaultSeed);
+    std::vector<float> texels(3 * 2 * GradientTable::kSize);
+    for (int i = 0; i < 2 * GradientTable::kSize; i++) {
+        texels[3 * i] = float(table.perm()[i]);
+        texels[3 * i + 1] = table.gradX()[i & GradientTable::kMask];
+        texels[3 * i + 2] = table.gradY()[i & GradientTable::kMask];
+    }
+    glGenTextures(1, &m_gradients);
+    glBindTexture(GL_TEXTURE_1D, m_gradients);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAX_LEVEL, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB32F, 2 * GradientTable::kSize, 0, GL_RGB, GL_FLOAT, texels.data());
+    glBindTexture(GL_TEXTURE_1D, 0);
+
+    GLint limit = 0;
+    glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &limit);
+    m_maxLevel = std::min(kMaxLevel, int(limit));
+}
+
+void TessellationRenderer::destroy()
+{
+    delete m_terrainProgram;
+    delete m_planetProgram;
+    m_terrainProgram = m_planetProgram = nullptr;
+    glDeleteBuffers(1, &m_terrainBuffer);
+    glDeleteBuffers(1, &m_planetBuffer);
+    glDeleteTextures(1, &m_gradients);
+    m_terrainBuffer = m_planetBuffer = m_gradients = 0;
+    m_terrainVao.destroy();
+    m_planetVao.destroy();
+}
+
+void TessellationRenderer::renderTerrain(const glm::mat4 &proj, const glm::mat4 &modelView, int viewportHeight,
+                                         int octaves, bool wireframe)
+{
+    QOpenGLShaderProgram *program = m_terrainProgram;
+    program->bind();
+    program->setUniformValue("projMatrix", toQMatrix(proj));
+    program->setUniformValue("mvMatrix", toQMatrix(modelView));
+    program->setUniformValue("normalMatrix", toQMatrix(modelView).normalMatrix());
+    program->setUniformValue("pixelsPerUnit", viewportHeight * proj[1][1] / 2);
+    program->setUniformValue("maxLevel", float(m_maxLevel));
+    program->setUniformValue("heightBound", kTerrainHeightScale * fbmBound<DefaultFbm>(octaves));
+    program->setUniformValue("origin", kTerrainOrigin);
+    program->setUniformValue("size", kTerrainSize);
+    program->setUniformValue("heightScale", kTerrainHeightScale);
+    program->setUniformValue("octaves", octaves);
+    program->setUniformValue("lightPos", QVector3D(70, 70, 70));
+
+    draw(program, m_terrainVao, kTerrainPatches * kTerrainPatches, wireframe);
+    program->release();
+}
+
+void TessellationRenderer::configurePlanet(double radius, double heightScale)
+{
+    m_planet.setRadius(radius);
+    m_planet.setHeightScale(heightScale);
+    m_planetHeightScale = heightScale;
+}
+
+void TessellationRenderer::renderPlanet(const glm::mat4 &proj, const glm::dmat4 &view, int viewportHeight, bool wireframe)
+{
+    glm::dvec3 camera = glm::dvec3(glm::inverse(view)[3]);
+    glm::mat3 rotation = glm::mat3(glm::dmat3(view));
+    double radius = m_planet.radius();
+
+    QOpenGLShaderProgram *program = m_planetProgram;
+    program->bind();
+    program->setUniformValue("projMatrix", toQMatrix(proj));
+    program->setUniformValue("viewRotation", toQMatrix(glm::mat4(rotation)).normalMatrix());
+    program->setUniformValue("pixelsPerUnit", viewportHeight * proj[1][1] / 2);
+    program->setUniformValue("maxLevel", float(m_maxLevel));
+    program->setUniformValue("minRadius", float(m_planet.minRadius() / radius));
+    program->setUniformValue("maxRadius", float(m_planet.maxRadius() / radius));
+    program->setUniformValue("heightScale", float(m_planetHeightScale));
+    program->setUniformValue("octaves", m_planet.octaves(kPlanetPatchDepth, m_maxLevel));
+    glm::vec3 light = glm::normalize(rotation * glm::vec3(1, 1, 1));
+    program->setUniformValue("lightDir", QVector3D(light.x, light.y, light.z));
+    // QOpenGLShaderProgram has no double uniforms
+    glUniform1d(program->uniformLocation("radius"), radius);
+    glUniform3d(program->uniformLocation("camera"), camera.x, camera.y, camera.z);
+
+    draw(program, m_planetVao, kCubeFaces * kPlanetPatches * kPlanetPatches, wireframe);
+    program->release();
+}
+
+// Draws `patches` patches with `program`
+void TessellationRenderer::draw(QOpenGLShaderProgram *program, QOpenGLVertexArrayObject &vao, int patches, bool wireframe)
+{
+    vao.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_1D, m_gradients);
+    glPatchParameteri(GL_PATCH_VERTICES, 4);
+
+    int passes = wireframe ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        bool lines = pass == 1;
+        program->setUniformValue("wireframe", lines);
+        glPolygonMode(GL_FRONT_AND_BACK, lines ? GL_LINE : GL_FILL);
+        if (lines) {
+            glEnable(GL_POLYGON_OFFSET_LINE);
+            glPolygonOffset(-1, -1);
+        }
+        glDrawArrays(GL_PATCHES, 0, 4 * patches);
+    }
+    glDisable(GL_POLYGON_OFFSET_LINE);
+    glPolygonOffset(0, 0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glBindTexture(GL_TEXTURE_1D, 0);
+    vao.release();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLVertexArrayObject>
+
+#include "lod/PlanetChunkBuilder.h"
+
+QT_FORWARD_DECLARE_CLASS(QOpenGLShaderProgram)
+
+// Draws the terrain or the planet through the tessellation stages, without building a mesh anywhere.
+//
+// Only a coarse grid of patches is uploaded, four corners each: kTerrainPatches^2 squares over the
+// terrain, or kPlanetPatches^2 per cube face. The control shader picks each edge's tessellation level
+// from its size on screen, so neighbouring patches agree along the edge they share and no cracks open
+// between levels, and drops patches outside the frustum (or behind the planet's horizon). The
+// evaluation shader then samples the same fractal noise as the CPU, from the GradientTable uploaded
+// as a texture, and takes normals from its analytic derivatives.
+//
+// Planet vertices are placed in double precision and made relative to the camera before they are
+// rounded to float, as PlanetRenderer's chunks are; the detail stops at kMaxLevel quads per patch edge,
+// so close to the ground PlanetRenderer's quadtree goes much further. Needs a current GL context throughout.
+class TessellationRenderer : protected QOpenGLFunctions_4_1_Core
+{
+public:
+    static constexpr int kTerrainPatches = 16;
+    // 6 * 16^2 patches: a face split as PlanetQuadtree's depth 4
+    static constexpr int kPlanetPatchDepth = 4;
+    static constexpr int kPlanetPatches = 1 << kPlanetPatchDepth;
+    // GL guarantees at least 64
+    static constexpr int kMaxLevel = 64;
+
+    void create();
+    void destroy();
+
+    // The terrain of Terrain::makeHeightfield() with `octaves` octaves, in its own (z up) coordinates
+    void renderTerrain(const glm::mat4 &proj, const glm::mat4 &modelView, int viewportHeight, int octaves,
+                       bool wireframe);
+
+    // Same planet as PlanetRenderer::configure(radius, heightScale)
+    void configurePlanet(double radius, double heightScale);
+    const PlanetChunkBuilder &planet() const { return m_planet; }
+    // `view` maps planet coordinates to the eye
+    void renderPlanet(const glm::mat4 &proj, const glm::dmat4 &view, int viewportHeight, bool wireframe);
+
+private:
+    void draw(QOpenGLShaderProgram *program, QOpenGLVertexArrayObject &vao, int patches, bool wireframe);
+
+    QOpenGLShaderProgram *m_terrainProgram = nullptr;
+    QOpenGLShaderProgram *m_planetProgram = nullptr;
+    QOpenGLVertexArrayObject m_terrainVao;
+    QOpenGLVertexArrayObject m_planetVao;
+    GLuint m_terrainBuffer = 0;
+    GLuint m_planetBuffer = 0;
+    GLuint m_gradients = 0;     // GradientTable::kDefaultSeed's table, see the shaders' noise functions
+    int m_maxLevel = 0;         // tessellation level cap: the smaller of kMaxLevel and the driver's limit
+
+    PlanetChunkBuilder m_planet; // bounds and octave counts only; the shaders do the sampling
+    double m_planetHeightScale = 0.0;
+};
@@ -0,0 +1,710 @@
+// planet_bench: times the generation stages over a sweep of resolutions.
+// Prints one record per (stage, variant, resolution) as JSON or CSV, so runs from different
+// builds can be diffed or plotted. Needs no display; links only planet_core.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "lod/ChunkBuilder.h"
+#include "lod/Clipmap.h"
+#include "lod/LodQuadtree.h"
+#include "lod/PlanetChunkBuilder.h"
+#include "lod/PlanetQuadtree.h"
+#include "noise/PerlinBatch.h"
+#include "shapes/CompactVertices.h"
+#include "shapes/Icosphere.h"
+#include "shapes/Sphere.h"
+#include "shapes/Terrain.h"
+#include "terraingenerator.h"
+#include "util/Parallel.h"
+
+// ====================================== HEAP ACCOUNTING ====================================== //
+
+// Every allocation in this process goes through these, so each record can report how far the heap
+// rose above where it started. Each block carries its size in a header of one max_align_t.
+static std::atomic<size_t> g_heapBytes{0};
+static std::atomic<size_t> g_heapPeak{0};
+static constexpr size_t kHeapHeader = alignof(std::max_align_t);
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    char *block = static_cast<char *>(std::malloc(size + kHeapHeader));
+    if (!block) return nullptr;
+    *reinterpret_cast<size_t *>(block) = size;
+    size_t now = g_heapBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = g_heapPeak.load(std::memory_order_relaxed);
+    while (now > peak && !g_heapPeak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    return block + kHeapHeader;
+}
+
+void *operator new(size_t size) {
+    void *p = operator new(size, std::nothrow);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    if (!p) return;
+    char *block = static_cast<char *>(p) - kHeapHeader;
+    g_heapBytes.fetch_sub(*reinterpret_cast<size_t *>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept { operator delete(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+// Starts a new high-water mark from the current heap size, which it returns
+static size_t resetHeapPeak() {
+    size_t now = g_heapBytes.load(std::memory_order_relaxed);
+    g_heapPeak.store(now, std::memory_order_relaxed);
+    return now;
+}
+
+struct Options {
+    bool csv = false;
+    std::string output;        // empty means stdout
+    double minTime = 0.25;     // seconds of repetitions per record
+    int threads = 0;
+    std::vector<int> sizes;    // param1 sweep; samples per side scale with it
+};
+
+struct Record {
+    std::string stage;
+    std::string variant;
+    int resolution = 0;        // samples (or segments) per side
+    long long samples = 0;     // noise evaluations per run
+    long long vertices = 0;    // mesh vertices per run
+    int runs = 0;
+    double medianSeconds = 0;
+    double minSeconds = 0;
+    long long peakHeapBytes = 0; // highest heap growth during the measurement
+    // Vertex format records only: uploaded size and the largest decoding errors
+    double bytesPerVertex = 0;
+    double maxPositionError = 0;  // world units; for sphere records, the largest chord error
+    double maxNormalErrorDeg = 0;
+};
+
+// Results are folded into this so the compiler cannot drop any measured work
+static double g_checksum = 0;
+
+// Runs `body` at least three times and for at least minTime seconds; keeps the median and best run
+static void measure(Record &record, double minTime, const std::function<void()> &body) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> times;
+    times.reserve(1024);
+    size_t heapBefore = resetHeapPeak();
+    Clock::time_point start = Clock::now();
+    while (times.size() < 3 || std::chrono::duration<double>(Clock::now() - start).count() < minTime) {
+        Clock::time_point a = Clock::now();
+        body();
+        times.push_back(std::chrono::duration<double>(Clock::now() - a).count());
+    }
+    record.peakHeapBytes = (long long)(g_heapPeak.load(std::memory_order_relaxed) - heapBefore);
+    std::sort(times.begin(), times.end());
+    record.runs = int(times.size());
+    record.medianSeconds = times[times.size() / 2];
+    record.minSeconds = times.front();
+}
+
+// Samples of an n x n grid over [0, 1), as the terrain lays them out
+static void gridSamples(int n, std::vector<float> &x, std::vector<float> &y) {
+    x.resize(size_t(n) * n);
+    y.resize(size_t(n) * n);
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < n; i++) {
+            x[size_t(j) * n + i] = float(i) / n;
+            y[size_t(j) * n + i] = float(j) / n;
+        }
+    }
+}
+
+static void benchNoise(const Options &options, std::vector<Record> &records) {
+    Terrain terrain;
+    PerlinBatch batch;
+    std::vector<PerlinBatch::Kernel> kernels;
+    for (PerlinBatch::Kernel k : {PerlinBatch::Kernel::Scalar, PerlinBatch::Kernel::SSE2, PerlinBatch::Kernel::AVX2}) {
+        batch.setKernel(k);
+        if (batch.kernel() == k) kernels.push_back(k);
+    }
+
+    for (int size : options.sizes) {
+        int n = Terrain::tileCount(size) + 1;
+        std::vector<float> x, y, out(size_t(n) * n), dx(out.size()), dy(out.size());
+        gridSamples(n, x, y);
+        // computePerlin() takes lattice coordinates; use the first octave's
+        std::vector<float> x8(x.size()), y8(y.size());
+        for (size_t i = 0; i < x.size(); i++) {
+            x8[i] = x[i] * 8;
+            y8[i] = y[i] * 8;
+        }
+        long long samples = (long long)n * n;
+
+        auto add = [&](const char *stage, std::string variant, const std::function<void()> &body) {
+            Record r;
+            r.stage = stage;
+            r.variant = std::move(variant);
+            r.resolution = n;
+            r.samples = samples;
+            measure(r, options.minTime, body);
+            g_checksum += out[out.size() / 3];
+            records.push_back(r);
+        };
+
+        add("computePerlin", "reference", [&] {
+            for (size_t i = 0; i < out.size(); i++) out[i] = terrain.computePerlin(x8[i], y8[i]);
+        });
+        add("getHeight", "reference", [&] {
+            for (size_t i = 0; i < out.size(); i++) out[i] = terrain.getHeight(x[i], y[i]);
+        });
+
+        for (PerlinBatch::Kernel k : kernels) {
+            batch.setKernel(k);
+            std::string name = PerlinBatch::kernelName(k);
+            add("computePerlin", "batch-" + name, [&] {
+                batch.computePerlin(x8.data(), y8.data(), out.data(), int(out.size()));
+            });
+            add("getHeight", "batch-" + name, [&] {
+                batch.getHeight(x.data(), y.data(), out.data(), int(out.size()));
+            });
+            add("getHeightAndGradient", "batch-" + name, [&] {
+                batch.getHeightAndGradient(x.data(), y.data(), out.data(), dx.data(), dy.data(), int(out.size()));
+            });
+            add("getHeightAndGradient", "scanline-" + name, [&] {
+                for (int j = 0; j < n; j++) {
+                    size_t row = size_t(j) * n;
+                    batch.getHeightRow(x.data() + row, y[row], out.data() + row, dx.data() + row, dy.data() + row, n);
+                }
+            });
+        }
+    }
+}
+
+// Reads every byte a GL upload would, without needing a context
+static double uploadStandIn(const Mesh &mesh) {
+    double sum = 0;
+    for (float v : mesh.vertices) sum += v;
+    return sum + double(mesh.indexCount());
+}
+
+// Furthest any triangle of a sphere mesh centered at the origin gets inside the true sphere
+static double chordError(const Mesh &mesh, double radius) {
+    auto position = [&](int corner) {
+        uint32_t index = mesh.wideIndices() ? mesh.indices32[size_t(corner)] : mesh.indices16[size_t(corner)];
+        const float *v = &mesh.vertices[size_t(index) * Mesh::kFloatsPerVertex];
+        return glm::dvec3(v[0], v[1], v[2]);
+    };
+    double error = 0;
+    for (int t = 0; t < mesh.triangleCount(); t++) {
+        glm::dvec3 a = position(3 * t), b = position(3 * t + 1), c = position(3 * t + 2);
+        glm::dvec3 normal = glm::cross(b - a, c - a);
+        if (glm::length(normal) == 0) continue;
+        error = std::max(error, radius - std::abs(glm::dot(glm::normalize(normal), a)));
+    }
+    return error;
+}
+
+static void benchMeshes(const Options &options, std::vector<Record> &records) {
+    std::string threads = "threads-" + std::to_string(resolveThreadCount(options.threads));
+
+    for (int size : options.sizes) {
+        Terrain terrain;
+        terrain.setThreadCount(options.threads);
+        Record r;
+        r.stage = "Terrain::makeFace";
+        r.variant = threads;
+        r.resolution = Terrain::tileCount(size) + 1;
+        r.samples = (long long)r.resolution * r.resolution;
+        measure(r, options.minTime, [&] { terrain.updateParams(size); });
+        r.vertices = terrain.generateShape()->vertexCount();
+        records.push_back(r);
+    }
+
+    for (int size : options.sizes) {
+        // The same number of segments in both directions as the terrain has tiles per side
+        int segments = Terrain::tileCount(size);
+        Sphere sphere;
+        sphere.setThreadCount(options.threads);
+        Record r;
+        r.stage = "Sphere::makeSphere";
+        r.variant = threads;
+        r.resolution = segments;
+        measure(r, options.minTime, [&] { sphere.updateParams(segments, segments); });
+        r.vertices = sphere.generateShape()->vertexCount();
+        r.samples = r.vertices;
+        r.maxPositionError = chordError(*sphere.generateShape(), 0.5);
+        records.push_back(r);
+
+        // The subdivision level nearest in triangle count, built from scratch ("cold") and returned
+        // to from a finer level already built ("cached", as when the slider moves back)
+        int sphereTriangles = sphere.generateShape()->triangleCount();
+        int level = 0;
+        while (level < Icosphere::kMaxSubdivisions &&
+               std::abs(Icosphere::triangleCount(level + 1) - sphereTriangles) <
+               std::abs(Icosphere::triangleCount(level) - sphereTriangles)) {
+            level++;
+        }
+        for (bool cached : {false, true}) {
+            Icosphere warm;
+            warm.setThreadCount(options.threads);
+            warm.updateParams(std::min(level + 1, Icosphere::kMaxSubdivisions));
+            Record ico;
+            ico.stage = "Icosphere::updateParams";
+            ico.variant = threads + (cached ? "-cached" : "-cold");
+            ico.resolution = level;
+            measure(ico, options.minTime, [&] {
+                if (cached) {
+                    warm.updateParams(level);
+                } else {
+                    Icosphere icosphere;
+                    icosphere.setThreadCount(options.threads);
+                    icosphere.updateParams(level);
+                    g_checksum += double(icosphere.generateShape()->vertexCount());
+                }
+            });
+            ico.vertices = Icosphere::vertexCount(level);
+            ico.samples = ico.vertices;
+            warm.updateParams(level);
+            ico.maxPositionError = chordError(*warm.generateShape(), 0.5);
+            records.push_back(ico);
+        }
+    }
+
+    // The viewer's path from worker to GPU: regenerate, hand the mesh over, upload it, drop it.
+    // "copy" is the old by-value hand-off (the terrain keeps its mesh and the worker copies it out),
+    // "shared" passes the one immutable mesh along. Compare their peak_heap_kb.
+    for (bool shared : {false, true}) {
+        for (int size : options.sizes) {
+            Terrain terrain;
+            terrain.setThreadCount(options.threads);
+            Record r;
+            r.stage = "mesh handoff";
+            r.variant = shared ? "shared" : "copy";
+            r.resolution = Terrain::tileCount(size) + 1;
+            r.samples = (long long)r.resolution * r.resolution;
+            measure(r, options.minTime, [&] {
+                terrain.updateParams(size);
+                if (shared) {
+                    MeshPtr mesh = terrain.takeShape();
+                    g_checksum += uploadStandIn(*mesh);
+                } else {
+                    Mesh published = *terrain.generateShape();
+                    Mesh taken = std::move(published);
+                    g_checksum += uploadStandIn(taken);
+                }
+            });
+            r.vertices = r.samples;
+            records.push_back(r);
+        }
+    }
+
+    for (int size : options.sizes) {
+        int resolution = Terrain::tileCount(size);
+        TerrainGenerator generator;
+        generator.setResolution(resolution);
+        Record r;
+        r.stage = "TerrainGenerator::generateTerrain";
+        r.variant = "single-thread";
+        r.resolution = resolution;
+        std::vector<float> verts;
+        measure(r, options.minTime, [&] { verts = generator.generateTerrain(); });
+        // Triangle soup of position, normal and color
+        r.vertices = (long long)(verts.size() * sizeof(float) / ColoredVertexFormat::stride);
+        // Every soup vertex samples the height for its position and normal
+        r.samples = r.vertices * 2;
+        g_checksum += verts.empty() ? 0 : verts[verts.size() / 2];
+        records.push_back(r);
+    }
+}
+
+// Encoding cost, size and accuracy of CompactVertex against Mesh's float vertices
+static void benchVertexFormats(const Options &options, std::vector<Record> &records) {
+    for (int size : options.sizes) {
+        Terrain terrain;
+        terrain.setThreadCount(options.threads);
+        terrain.updateParams(size);
+        MeshPtr mesh = terrain.takeShape();
+        int count = mesh->vertexCount();
+
+        Record full;
+        full.stage = "vertex format";
+        full.variant = "float32";
+        full.resolution = Terrain::tileCount(size) + 1;
+        full.vertices = count;
+        full.bytesPerVertex = double(mesh->vertexBytes()) / count;
+        records.push_back(full);
+
+        Record r = full;
+        r.variant = "compact";
+        std::vector<CompactVertex> compact(count);
+        CompactBounds bounds;
+        measure(r, options.minTime, [&] {
+            bounds = compactBounds(*mesh);
+            writeCompactVertices(*mesh, bounds, compact.data());
+        });
+        r.bytesPerVertex = sizeof(CompactVertex);
+
+        for (int i = 0; i < count; i++) {
+            const float *v = &mesh->vertices[size_t(i) * Mesh::kFloatsPerVertex];
+            glm::vec3 p = decodePosition(compact[i], bounds);
+            glm::vec3 error = glm::abs(p - glm::vec3(v[0], v[1], v[2]));
+            r.maxPositionError = std::max({r.maxPositionError, double(error.x), double(error.y), double(error.z)});
+
+            float cosine = glm::dot(decodeNormal(compact[i]), glm::normalize(glm::vec3(v[3], v[4], v[5])));
+            double degrees = glm::degrees(std::acos(std::clamp(double(cosine), -1.0, 1.0)));
+            r.maxNormalErrorDeg = std::max(r.maxNormalErrorDeg, degrees);
+        }
+        g_checksum += compact[count / 2].position[2];
+        records.push_back(r);
+    }
+}
+
+// CDLOD selection from a viewer-like camera over growing terrains. The drawn vertex count should
+// only grow with the number of levels, not with the area; the chunk build is the cost of one node.
+static void benchLod(const Options &options, std::vector<Record> &records) {
+    ChunkBuilder builder;
+    float bound = builder.heightBound();
+    const int gridSize = 32;
+    const float finestQuadSize = 1.f / 32;
+    const int viewportHeight = 800;
+
+    glm::vec3 camera(0.f, -3.f, 2.f);
+    glm::mat4 view = glm::lookAt(camera, glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f));
+    std::vector<LodNode> nodes;
+    for (int extent : {10, 160, 2560, 10240}) {
+        LodQuadtree tree;
+        tree.configure(float(extent), finestQuadSize, gridSize, -bound, bound);
+        glm::mat4 proj = glm::perspective(glm::radians(45.f), 1.6f, 0.01f, 2 * tree.rootSize());
+        tree.setView(viewportHeight * proj[1][1] / 2, 8.f);
+
+        Record r;
+        r.stage = "cdlod select";
+        r.variant = "extent-" + std::to_string(extent);
+        r.resolution = extent;
+        measure(r, options.minTime, [&] { tree.select(camera, proj * view, nodes); });
+        // Each drawn quadrant is a (gridSize / 2 + 1)^2 block of its node's vertices
+        for (const LodNode &node : nodes) {
+            for (int quadrant = 0; quadrant < 4; quadrant++) {
+                if (node.quadrants & (1 << quadrant)) r.vertices += (gridSize / 2 + 1) * (gridSize / 2 + 1);
+            }
+        }
+        g_checksum += double(nodes.size());
+        records.push_back(r);
+    }
+
+    LodQuadtree tree;
+    tree.configure(160.f, finestQuadSize, gridSize, -bound, bound);
+    std::vector<unsigned char> chunk(size_t(ChunkBuilder::vertexCount(gridSize)) * ChunkVertexFormat::stride);
+    Record r;
+    r.stage = "cdlod build";
+    r.variant = "chunk";
+    r.resolution = gridSize + 1;
+    r.samples = ChunkBuilder::vertexCount(gridSize);
+    r.vertices = r.samples;
+    r.bytesPerVertex = double(ChunkVertexFormat::stride);
+    int node = 0;
+    measure(r, options.minTime, [&] {
+        // A different node each run, as when the camera moves
+        int side = tree.nodesPerSide(0);
+        builder.build(tree, 0, node % side, (node / side) % side, chunk.data());
+        node++;
+    });
+    g_checksum += chunk[chunk.size() / 2];
+    records.push_back(r);
+}
+
+// Earth-sized planet, in metres, seen 10 degrees below the horizontal from a range of altitudes
+static void benchPlanet(const Options &options, std::vector<Record> &records) {
+    const double radius = 6371000.0;
+    const int gridSize = 32;
+    const int maxDepth = 20;
+    const int viewportHeight = 800;
+
+    PlanetChunkBuilder builder;
+    builder.setRadius(radius);
+    builder.setHeightScale(0.002);
+    std::vector<PlanetNode> nodes;
+    for (int altitude : {1000000, 10000, 100, 1}) {
+        PlanetQuadtree tree;
+        tree.configure(radius, builder.minRadius(), builder.maxRadius(), gridSize, maxDepth);
+        tree.setRadiusBounds([&](const PlanetNode &node) { return builder.radiusBounds(node, gridSize); });
+        glm::dvec3 camera(0.0, 0.0, builder.maxRadius() + altitude);
+        glm::dvec3 forward(0.0, std::cos(glm::radians(10.0)), -std::sin(glm::radians(10.0)));
+        glm::dmat4 view = glm::lookAt(camera, camera + forward, glm::dvec3(0.0, 0.0, 1.0));
+        glm::dmat4 proj = glm::perspective(glm::radians(45.0), 1.6, altitude / 10.0, 2 * radius);
+        tree.setView(viewportHeight * proj[1][1] / 2, 8.0);
+
+        Record r;
+        r.stage = "planet select";
+        r.variant = "altitude-" + std::to_string(altitude) + "m";
+        r.resolution = gridSize + 1;
+        // Later runs find every node's radius bounds cached, as frames after the first do
+        measure(r, options.minTime, [&] { tree.select(camera, proj * view, nodes); });
+        r.vertices = (long long)nodes.size() * PlanetChunkBuilder::vertexCount(gridSize);
+        g_checksum += double(nodes.size());
+        records.push_back(r);
+    }
+
+    std::vector<unsigned char> chunk(size_t(PlanetChunkBuilder::vertexCount(gridSize)) * MeshVertexFormat::stride);
+    Record r;
+    r.stage = "planet build";
+    r.variant = "chunk";
+    r.resolution = gridSize + 1;
+    r.samples = (long long)(gridSize + 3) * (gridSize + 3);
+    r.vertices = PlanetChunkBuilder::vertexCount(gridSize);
+    r.bytesPerVertex = double(MeshVertexFormat::stride);
+    int node = 0;
+    measure(r, options.minTime, [&] {
+        // A different depth-12 node each run, each with all the octaves it would get on screen
+        const int depth = 12;
+        builder.build({node % kCubeFaces, depth, (node * 7) % (1 << depth), (node * 13) % (1 << depth)},
+                      gridSize, chunk.data());
+        node++;
+    });
+    g_checksum += chunk[chunk.size() / 2];
+    records.push_back(r);
+}
+
+// Geometry clipmap as the viewer's: a full fill, then a camera walking at a few speeds (finest samples
+// per frame). A frame's samples, and its time, should follow the speed rather than the clipmap's area.
+static void benchClipmap(const Options &options, std::vector<Record> &records) {
+    const int levels = 10;
+    const double spacing = 0.05;
+    const int framesPerRun = 16;
+
+    Clipmap clipmap;
+    Record fill;
+    fill.stage = "clipmap update";
+    fill.variant = "fill";
+    fill.resolution = Clipmap::kSide;
+    measure(fill, options.minTime, [&] {
+        clipmap.configure(levels, spacing, 4);
+        clipmap.update(glm::dvec2(0.0));
+    });
+    fill.samples = clipmap.stats().samples;
+    g_checksum += clipmap.height(0, clipmap.level(0).x0, clipmap.level(0).y0);
+    records.push_back(fill);
+
+    for (int speed : {1, 8, 64}) {
+        Record r;
+        r.stage = "clipmap update";
+        r.variant = "walk-" + std::to_string(speed) + "x" + std::to_string(framesPerRun);
+        r.resolution = Clipmap::kSide;
+        glm::dvec2 center(0.0);
+        clipmap.configure(levels, spacing, 4);
+        clipmap.update(center);
+        long long samples = 0;
+        int runs = 0;
+        measure(r, options.minTime, [&] {
+            for (int frame = 0; frame < framesPerRun; frame++) {
+                center += glm::dvec2(1.0, 0.5) * (speed * spacing);
+                clipmap.update(center);
+                clipmap.clearDirty();
+                samples += clipmap.stats().samples;
+            }
+            runs++;
+        });
+        r.samples = samples / runs;
+        g_checksum += clipmap.height(0, clipmap.level(0).x0, clipmap.level(0).y0);
+        records.push_back(r);
+    }
+}
+
+// The viewer's chunk culling of its mesh, seen from an orbiting camera: the terrain's boxes and the
+// icosphere's spheres and normal cones, four chunks per SSE2 instruction ("simd") or one at a time
+// ("scalar"). Samples are chunk tests; vertices, the indices left to draw per frame.
+static void benchCull(const Options &options, std::vector<Record> &records) {
+    const int framesPerRun = 64;
+
+    Terrain terrain;
+    terrain.setThreadCount(options.threads);
+    terrain.updateParams(100);
+    Icosphere icosphere;
+    icosphere.setThreadCount(options.threads);
+    icosphere.updateParams(6);
+    glm::mat4 proj = glm::perspective(45.f, 1.6f, 0.01f, 100.f);
+
+    for (bool sphere : {false, true}) {
+        MeshPtr mesh = sphere ? icosphere.generateShape() : terrain.generateShape();
+        const MeshChunks &chunks = mesh->chunks;
+        // As in the viewer: the mesh at the origin, the camera orbiting it closer than the terrain's edge
+        auto view = [&](int frame, glm::vec3 &eye) {
+            float angle = 2 * glm::pi<float>() * float(frame) / framesPerRun;
+            eye = glm::vec3(std::cos(angle), std::sin(angle), 0.4f) * (sphere ? 1.5f : 3.f);
+            return proj * glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f));
+        };
+
+        // Both paths add in the same order, so they must agree on every chunk
+        std::vector<uint8_t> visible, reference;
+        long long drawnIndices = 0;
+        for (int frame = 0; frame < framesPerRun; frame++) {
+            glm::vec3 eye;
+            glm::mat4 viewProj = view(frame, eye);
+            chunks.cull(viewProj, eye, visible);
+            chunks.cullScalar(viewProj, eye, reference);
+            if (visible != reference) {
+                std::fprintf(stderr, "planet_bench: SIMD and scalar chunk culling disagree (%s, frame %d)\n",
+                             sphere ? "icosphere" : "terrain", frame);
+            }
+            for (int c = 0; c < chunks.count(); c++) drawnIndices += visible[c] ? chunks.indexCount[c] : 0;
+        }
+
+        for (bool simd : {true, false}) {
+            Record r;
+            r.stage = "chunk cull";
+            r.variant = std::string(sphere ? "icosphere-" : "terrain-") + (simd ? "simd" : "scalar");
+            r.resolution = chunks.count();
+            measure(r, options.minTime, [&] {
+                for (int frame = 0; frame < framesPerRun; frame++) {
+                    glm::vec3 eye;
+                    glm::mat4 viewProj = view(frame, eye);
+                    g_checksum += simd ? chunks.cull(viewProj, eye, visible) : chunks.cullScalar(viewProj, eye, visible);
+                }
+            });
+            r.samples = (long long)chunks.count() * framesPerRun;
+            r.vertices = drawnIndices / framesPerRun;
+            records.push_back(r);
+        }
+    }
+}
+
+static double nsPerSample(const Record &r) {
+    return r.samples > 0 ? r.medianSeconds * 1e9 / double(r.samples) : 0;
+}
+
+static double verticesPerSecond(const Record &r) {
+    return r.vertices > 0 && r.medianSeconds > 0 ? double(r.vertices) / r.medianSeconds : 0;
+}
+
+static void writeJson(std::FILE *out, const Options &options, const std::vector<Record> &records) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"benchmark\": \"planet_bench\",\n");
+    std::fprintf(out, "  \"best_kernel\": \"%s\",\n", PerlinBatch::kernelName(PerlinBatch::bestKernel()));
+    std::fprintf(out, "  \"threads\": %d,\n", resolveThreadCount(options.threads));
+#ifdef NDEBUG
+    std::fprintf(out, "  \"optimized\": true,\n");
+#else
+    std::fprintf(out, "  \"optimized\": false,\n");
+#endif
+    std::fprintf(out, "  \"checksum\": %.9g,\n", g_checksum);
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < records.size(); i++) {
+        const Record &r = records[i];
+        std::fprintf(out,
+            "    {\"stage\": \"%s\", \"variant\": \"%s\", \"resolution\": %d, \"samples\": %lld, "
+            "\"vertices\": %lld, \"runs\": %d, \"median_ms\": %.6f, \"min_ms\": %.6f, "
+            "\"ns_per_sample\": %.3f, \"vertices_per_s\": %.0f, \"peak_heap_kb\": %lld, "
+            "\"bytes_per_vertex\": %.1f, \"max_position_error\": %.3g, \"max_normal_error_deg\": %.3g}%s\n",
+            r.stage.c_str(), r.variant.c_str(), r.resolution, r.samples, r.vertices, r.runs,
+            r.medianSeconds * 1e3, r.minSeconds * 1e3, nsPerSample(r), verticesPerSecond(r), r.peakHeapBytes / 1024,
+            r.bytesPerVertex, r.maxPositionError, r.maxNormalErrorDeg,
+            i + 1 < records.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+static void writeCsv(std::FILE *out, const std::vector<Record> &records) {
+    std::fprintf(out, "stage,variant,resolution,samples,vertices,runs,median_ms,min_ms,ns_per_sample,vertices_per_s,peak_heap_kb,"
+                      "bytes_per_vertex,max_position_error,max_normal_error_deg\n");
+    for (const Record &r : records) {
+        std::fprintf(out, "%s,%s,%d,%lld,%lld,%d,%.6f,%.6f,%.3f,%.0f,%lld,%.1f,%.3g,%.3g\n",
+                     r.stage.c_str(), r.variant.c_str(), r.resolution, r.samples, r.vertices, r.runs,
+                     r.medianSeconds * 1e3, r.minSeconds * 1e3, nsPerSample(r), verticesPerSecond(r),
+                     r.peakHeapBytes / 1024, r.bytesPerVertex, r.maxPositionError, r.maxNormalErrorDeg);
+    }
+}
+
+static void printUsage(std::FILE *to) {
+    std::fprintf(to,
+        "usage: planet_bench [options]\n"
+        "\n"
+        "  --csv             CSV instead of JSON\n"
+        "  -o, --output F    write results to F instead of stdout\n"
+        "  --sizes A,B,...   param1 values to sweep (default 2,10,50,100)\n"
+        "  --min-time S      seconds to repeat each measurement for (default 0.25)\n"
+        "  --quick           --sizes 2,10 --min-time 0.02, for smoke tests\n"
+        "  -t, --threads N   mesh generation threads, 0 = one per hardware thread (default 0)\n"
+        "  -h, --help        show this help\n");
+}
+
+static bool parseSizes(const char *text, std::vector<int> &sizes) {
+    sizes.clear();
+    const char *p = text;
+    while (*p) {
+        char *end = nullptr;
+        long value = std::strtol(p, &end, 10);
+        if (end == p || value < 1 || value > 10000) return false;
+        sizes.push_back(int(value));
+        p = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return !sizes.empty();
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    options.sizes = {2, 10, 50, 100};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(stdout);
+            return 0;
+        } else if (arg == "--csv") {
+            options.csv = true;
+        } else if (arg == "--quick") {
+            options.sizes = {2, 10};
+            options.minTime = 0.02;
+        } else if ((arg == "-o" || arg == "--output") && value) {
+            options.output = value;
+            i++;
+        } else if (arg == "--sizes" && value && parseSizes(value, options.sizes)) {
+            i++;
+        } else if (arg == "--min-time" && value) {
+            options.minTime = std::atof(value);
+            i++;
+        } else if ((arg == "-t" || arg == "--threads") && value) {
+            options.threads = std::max(0, std::atoi(value));
+            i++;
+        } else {
+            std::fprintf(stderr, "planet_bench: bad argument '%s'\n", arg.c_str());
+            printUsage(stderr);
+            return 2;
+        }
+    }
+
+    std::vector<Record> records;
+    benchNoise(options, records);
+    benchMeshes(options, records);
+    benchVertexFormats(options, records);
+    benchLod(options, records);
+    benchPlanet(options, records);
+    benchClipmap(options, records);
+    benchCull(options, records);
+
+    std::FILE *out = stdout;
+    if (!options.output.empty()) {
+        out = std::fopen(options.output.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "planet_bench: cannot open '%s' for writing\n", options.output.c_str());
+            return 1;
+        }
+    }
+    if (options.csv) {
+        writeCsv(out, records);
+    } else {
+        writeJson(out, options, records);
+    }
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,236 @@
+// planet-gen: headless mesh generator.
+// Builds terrain, sphere or icosphere meshes with the same generators as the viewer and writes them as OBJ or PLY,
+// to a file or to stdout, so batch pipelines can produce meshes without a display.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "shapes/Icosphere.h"
+#include "shapes/Mesh.h"
+#include "shapes/MeshIO.h"
+#include "shapes/Sphere.h"
+#include "shapes/Terrain.h"
+
+struct Options {
+    std::string shape;
+    int param1 = 50;
+    bool hasParam1 = false;
+    int param2 = 50;
+    int octaves = 4;
+    uint32_t seed = GradientTable::kDefaultSeed;
+    int count = 1;
+    int threads = 0;
+    std::string format;       // "obj" or "ply"; empty means from the output extension
+    std::string output = "-"; // "-" is stdout
+    bool quiet = false;
+};
+
+static void printUsage(std::FILE *to) {
+    std::fprintf(to,
+        "usage: planet-gen <terrain|sphere|icosphere> [options]\n"
+        "\n"
+        "  -p, --param1 N    terrain: 5N tiles per side, at most %d; sphere: latitude bands,\n"
+        "                    at most %d (default 50); icosphere: subdivision levels, at most %d (default 5)\n"
+        "      --param2 N    sphere: longitude wedges, at most %d (default 50)\n"
+        "      --octaves N   terrain: octaves of fractal noise (default 4)\n"
+        "      --seed N      terrain: gradient table seed (default %u)\n"
+        "      --count N     terrain: generate N meshes for seeds seed .. seed+N-1;\n"
+        "                    the output path must then contain {seed}\n"
+        "  -t, --threads N   generation threads, 0 = one per hardware thread (default 0)\n"
+        "  -f, --format F    obj or ply (default: from the output extension, else obj)\n"
+        "  -o, --output F    output file, - for stdout (default -)\n"
+        "  -q, --quiet       no mesh statistics on stderr\n"
+        "  -h, --help        show this help\n",
+        Terrain::kMaxParam1, Sphere::kMaxSegments, Icosphere::kMaxSubdivisions, Sphere::kMaxSegments,
+        unsigned(GradientTable::kDefaultSeed));
+}
+
+static bool parseInt(const char *text, long long min, long long max, long long &value) {
+    char *end = nullptr;
+    value = std::strtoll(text, &end, 10);
+    return end != text && *end == '\0' && value >= min && value <= max;
+}
+
+// Returns 0 on success, otherwise the exit code to stop with
+static int parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(stdout);
+            std::exit(0);
+        }
+        if (arg == "-q" || arg == "--quiet") {
+            options.quiet = true;
+            continue;
+        }
+        if (arg[0] != '-' || arg == "-") {
+            if (!options.shape.empty()) {
+                std::fprintf(stderr, "planet-gen: unexpected argument '%s'\n", arg.c_str());
+                return 2;
+            }
+            options.shape = arg;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "planet-gen: %s needs a value\n", arg.c_str());
+            return 2;
+        }
+        const char *value = argv[++i];
+        long long number = 0;
+        bool valid = true;
+        if (arg == "-p" || arg == "--param1") {
+            valid = parseInt(value, 0, 100000, number);
+            options.param1 = int(number);
+            options.hasParam1 = true;
+        } else if (arg == "--param2") {
+            valid = parseInt(value, 1, 100000, number);
+            options.param2 = int(number);
+        } else if (arg == "--octaves") {
+            valid = parseInt(value, 1, 32, number);
+            options.octaves = int(number);
+        } else if (arg == "--seed") {
+            valid = parseInt(value, 0, 0xffffffffLL, number);
+            options.seed = uint32_t(number);
+        } else if (arg == "--count") {
+            valid = parseInt(value, 1, 1000000000, number);
+            options.count = int(number);
+        } else if (arg == "-t" || arg == "--threads") {
+            valid = parseInt(value, 0, 4096, number);
+            options.threads = int(number);
+        } else if (arg == "-f" || arg == "--format") {
+            options.format = value;
+            valid = options.format == "obj" || options.format == "ply";
+        } else if (arg == "-o" || arg == "--output") {
+            options.output = value;
+        } else {
+            std::fprintf(stderr, "planet-gen: unknown option '%s'\n", arg.c_str());
+            return 2;
+        }
+        if (!valid) {
+            std::fprintf(stderr, "planet-gen: invalid value '%s' for %s\n", value, arg.c_str());
+            return 2;
+        }
+    }
+
+    if (options.shape != "terrain" && options.shape != "sphere" && options.shape != "icosphere") {
+        printUsage(stderr);
+        return 2;
+    }
+    if (options.param1 < 1 && options.shape != "icosphere") {
+        std::fprintf(stderr, "planet-gen: %s needs --param1 of at least 1\n", options.shape.c_str());
+        return 2;
+    }
+    if (options.shape == "terrain" && options.param1 > Terrain::kMaxParam1) {
+        std::fprintf(stderr, "planet-gen: terrain takes --param1 of at most %d\n", Terrain::kMaxParam1);
+        return 2;
+    }
+    if (options.shape == "sphere" && std::max(options.param1, options.param2) > Sphere::kMaxSegments) {
+        std::fprintf(stderr, "planet-gen: sphere takes --param1 and --param2 of at most %d\n", Sphere::kMaxSegments);
+        return 2;
+    }
+    if (options.format.empty()) {
+        size_t dot = options.output.rfind('.');
+        bool ply = dot != std::string::npos && options.output.compare(dot, std::string::npos, ".ply") == 0;
+        options.format = ply ? "ply" : "obj";
+    }
+    if (options.count > 1 && options.output.find("{seed}") == std::string::npos) {
+        std::fprintf(stderr, "planet-gen: --count needs an output path containing {seed}\n");
+        return 2;
+    }
+    return 0;
+}
+
+static std::string outputPath(const Options &options, uint32_t seed) {
+    std::string path = options.output;
+    size_t at = path.find("{seed}");
+    if (at != std::string::npos) path.replace(at, 6, std::to_string(seed));
+    return path;
+}
+
+static bool writeMesh(const Mesh &mesh, const Options &options, const std::string &path) {
+    bool ply = options.format == "ply";
+    if (path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        bool ok = ply ? writePly(mesh, std::cout) : writeObj(mesh, std::cout);
+        std::cout.flush();
+        return ok && bool(std::cout);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "planet-gen: cannot open '%s' for writing\n", path.c_str());
+        return false;
+    }
+    bool ok = ply ? writePly(mesh, file) : writeObj(mesh, file);
+    file.close();
+    if (!ok || !file) {
+        std::fprintf(stderr, "planet-gen: failed writing '%s'\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static int generate(const Options &options) {
+    if (options.shape == "sphere") {
+        Sphere sphere;
+        sphere.setThreadCount(options.threads);
+        sphere.updateParams(options.param1, options.param2);
+        const Mesh &mesh = *sphere.generateShape();
+        if (!options.quiet) std::fprintf(stderr, "sphere: %s\n", mesh.describe().c_str());
+        return writeMesh(mesh, options, outputPath(options, options.seed)) ? 0 : 1;
+    }
+
+    if (options.shape == "icosphere") {
+        if (options.param1 > Icosphere::kMaxSubdivisions) {
+            std::fprintf(stderr, "planet-gen: an icosphere has at most %d subdivision levels\n", Icosphere::kMaxSubdivisions);
+            return 2;
+        }
+        Icosphere icosphere;
+        icosphere.setThreadCount(options.threads);
+        icosphere.updateParams(options.hasParam1 ? options.param1 : 5);
+        const Mesh &mesh = *icosphere.generateShape();
+        if (!options.quiet) std::fprintf(stderr, "icosphere: %s\n", mesh.describe().c_str());
+        return writeMesh(mesh, options, outputPath(options, options.seed)) ? 0 : 1;
+    }
+
+    // One Terrain is reused for every seed; only its gradient table changes
+    Terrain terrain;
+    terrain.setThreadCount(options.threads);
+    terrain.setOctaves(options.octaves);
+    for (int i = 0; i < options.count; i++) {
+        uint32_t seed = options.seed + uint32_t(i);
+        terrain.setSeed(seed);
+        terrain.updateParams(options.param1);
+        const Mesh &mesh = *terrain.generateShape();
+
+        std::string path = outputPath(options, seed);
+        if (!options.quiet) std::fprintf(stderr, "terrain seed %u: %s\n", unsigned(seed), mesh.describe().c_str());
+        if (!writeMesh(mesh, options, path)) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (int code = parseOptions(argc, argv, options)) return code;
+    try {
+        return generate(options);
+    } catch (const std::bad_alloc &) {
+        std::fprintf(stderr, "planet-gen: out of memory\n");
+        return 1;
+    }
+}
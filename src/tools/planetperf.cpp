@@ -0,0 +1,396 @@
+// planet_perf: performance regression checks for the generators, run by ctest (label "perf").
+//
+// Each workload builds a fixed mesh several times and compares against the committed baseline:
+//   - the mesh hash must match exactly, so a speedup that changes the geometry fails
+// and, with --check-throughput, on the machine the baseline was written on:
+//   - throughput (vertices/s, best run) may not drop more than the threshold below the baseline
+//   - peak RSS of the process may not grow more than the threshold above it
+// Workloads that evaluate noise keep one hash per kernel, since the kernels round slightly differently,
+// and are checked with every kernel this CPU supports. A hash missing from the baseline fails the check.
+// Each workload runs in its own process, so peak RSS belongs to that workload alone.
+// After an intended change, refresh the baseline with the perf_update_baseline build target.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "noise/PerlinBatch.h"
+#include "shapes/Mesh.h"
+#include "shapes/Sphere.h"
+#include "shapes/Terrain.h"
+
+struct Workload {
+    const char *name;
+    const char *description;
+    bool noise; // whether the mesh depends on the noise kernel
+    std::function<MeshPtr(int threads, PerlinBatch::Kernel kernel)> build;
+};
+
+static std::vector<Workload> workloads() {
+    return {
+        {"terrain-500", "500 x 500 tile terrain", true, [](int threads, PerlinBatch::Kernel kernel) {
+            Terrain terrain;
+            terrain.setThreadCount(threads);
+            terrain.setKernel(kernel);
+            terrain.updateParams(100); // 5 tiles per unit of param1
+            return terrain.generateShape();
+        }},
+        {"sphere-256", "256 x 256 segment sphere", false, [](int threads, PerlinBatch::Kernel) {
+            Sphere sphere;
+            sphere.setThreadCount(threads);
+            sphere.updateParams(256, 256);
+            return sphere.generateShape();
+        }},
+    };
+}
+
+// Peak resident set size of this process so far, in KiB
+static long peakRssKb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return long(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return long(usage.ru_maxrss / 1024); // bytes on macOS
+#else
+    return long(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// The noise kernels this CPU can run, best last
+static std::vector<PerlinBatch::Kernel> supportedKernels() {
+    std::vector<PerlinBatch::Kernel> kernels;
+    for (PerlinBatch::Kernel kernel : {PerlinBatch::Kernel::Scalar, PerlinBatch::Kernel::SSE2, PerlinBatch::Kernel::AVX2}) {
+        PerlinBatch batch;
+        batch.setKernel(kernel);
+        if (batch.kernel() == kernel) kernels.push_back(kernel);
+    }
+    return kernels;
+}
+
+// ====================================== KERNEL CHECK ====================================== //
+
+// Every noise kernel this CPU runs against Terrain's scalar path, which PerlinBatch promises to match
+// within kTolerance: plain noise, fBm with and without gradients, and the scanline rows, at octave
+// counts with a compiled kernel and beyond them. Samples cover the terrain and a margin around it.
+static bool checkKernels() {
+    const int n = 129;
+    std::vector<float> x, y;
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < n; i++) {
+            x.push_back(-0.25f + 1.5f * float(i) / (n - 1));
+            y.push_back(-0.25f + 1.5f * float(j) / (n - 1));
+        }
+    }
+    std::vector<float> expected(x.size()), out(x.size()), dx(x.size()), dy(x.size());
+
+    bool ok = true;
+    auto compare = [&](PerlinBatch::Kernel kernel, const char *function, int octaves) {
+        float worst = 0.f;
+        for (size_t i = 0; i < out.size(); i++) worst = std::max(worst, std::abs(out[i] - expected[i]));
+        bool pass = worst <= PerlinBatch::kTolerance;
+        if (!pass) {
+            std::printf("  %-6s %-21s %2d octaves: off by %.3g, tolerance %.3g   FAILED\n",
+                        PerlinBatch::kernelName(kernel), function, octaves, worst, PerlinBatch::kTolerance);
+        }
+        ok &= pass;
+    };
+
+    Terrain terrain;
+    for (PerlinBatch::Kernel kernel : supportedKernels()) {
+        PerlinBatch batch;
+        batch.setKernel(kernel);
+
+        // computePerlin() takes lattice coordinates; use the first octave's
+        std::vector<float> x8(x.size()), y8(y.size());
+        for (size_t i = 0; i < x.size(); i++) {
+            x8[i] = x[i] * 8;
+            y8[i] = y[i] * 8;
+            expected[i] = terrain.computePerlin(x8[i], y8[i]);
+        }
+        batch.computePerlin(x8.data(), y8.data(), out.data(), int(out.size()));
+        compare(kernel, "computePerlin", 1);
+
+        for (int octaves = 1; octaves <= kMaxFixedOctaves + 2; octaves++) {
+            terrain.setOctaves(octaves);
+            batch.setOctaves(octaves);
+            for (size_t i = 0; i < x.size(); i++) expected[i] = terrain.getHeight(x[i], y[i]);
+
+            batch.getHeight(x.data(), y.data(), out.data(), int(out.size()));
+            compare(kernel, "getHeight", octaves);
+            batch.getHeightAndGradient(x.data(), y.data(), out.data(), dx.data(), dy.data(), int(out.size()));
+            compare(kernel, "getHeightAndGradient", octaves);
+            for (int j = 0; j < n; j++) {
+                size_t row = size_t(j) * n;
+                batch.getHeightRow(x.data() + row, y[row], out.data() + row, dx.data() + row, dy.data() + row, n);
+            }
+            compare(kernel, "getHeightRow", octaves);
+        }
+        std::printf("%s kernels: %s\n", PerlinBatch::kernelName(kernel), ok ? "ok" : "FAILED");
+    }
+    return ok;
+}
+
+// ====================================== BASELINE FILE ====================================== //
+
+// Plain text, one "workload key value" entry per line; '#' starts a comment.
+// Keys: vertices_per_s, peak_rss_kb, and hash.<kernel> for workloads that use noise, hash otherwise
+using Baseline = std::map<std::string, std::map<std::string, std::string>>;
+
+static bool readBaseline(const std::string &path, Baseline &baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string workload, key, value;
+        if (fields >> workload >> key >> value) baseline[workload][key] = value;
+    }
+    return true;
+}
+
+static bool writeBaseline(const std::string &path, const Baseline &baseline) {
+    std::ofstream out(path);
+    out << "# planet_perf baseline: <workload> <key> <value>\n"
+        << "# Regenerate with the perf_update_baseline build target\n";
+    for (const auto &[workload, entries] : baseline) {
+        for (const auto &[key, value] : entries) {
+            out << workload << " " << key << " " << value << "\n";
+        }
+    }
+    return bool(out);
+}
+
+// ====================================== RUN ====================================== //
+
+struct Options {
+    std::string workload;
+    std::string baselinePath;
+    double threshold = 0.25;
+    int runs = 5;
+    double minTime = 1.0;
+    int threads = 1;
+    bool update = false;
+    bool checkThroughput = false;
+};
+
+struct Result {
+    double verticesPerSecond = 0;
+    long peakRssKb = 0;
+    std::map<std::string, std::string> hashes; // baseline key -> mesh hash
+};
+
+static std::string hashKey(const Workload &workload, PerlinBatch::Kernel kernel) {
+    return workload.noise ? std::string("hash.") + PerlinBatch::kernelName(kernel) : std::string("hash");
+}
+
+static std::string meshHash(const Mesh &mesh) {
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016" PRIx64, mesh.contentHash());
+    return hash;
+}
+
+static Result run(const Workload &workload, const Options &options) {
+    using Clock = std::chrono::steady_clock;
+    const PerlinBatch::Kernel best = PerlinBatch::bestKernel();
+    std::vector<double> times;
+    MeshPtr mesh = workload.build(options.threads, best); // warm-up: page in the code and the allocator
+    Clock::time_point begin = Clock::now();
+    while (int(times.size()) < options.runs ||
+           std::chrono::duration<double>(Clock::now() - begin).count() < options.minTime) {
+        mesh.reset(); // only one mesh is ever alive, as in the viewer
+        Clock::time_point start = Clock::now();
+        mesh = workload.build(options.threads, best);
+        times.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+
+    // The best run is the least disturbed by the rest of the machine, so it is the most repeatable
+    Result result;
+    result.verticesPerSecond = mesh->vertexCount() / times.front();
+    result.peakRssKb = peakRssKb();
+    result.hashes[hashKey(workload, best)] = meshHash(*mesh);
+    std::printf("%s (%s): %d vertices, %d triangles, %d runs, best %.3f ms, median %.3f ms\n",
+                workload.name, workload.description, mesh->vertexCount(), mesh->triangleCount(),
+                int(times.size()), times.front() * 1e3, times[times.size() / 2] * 1e3);
+
+    // One untimed build with each of the other kernels, after the peak RSS is taken
+    if (workload.noise) {
+        for (PerlinBatch::Kernel kernel : supportedKernels()) {
+            if (kernel == best) continue;
+            mesh.reset();
+            mesh = workload.build(options.threads, kernel);
+            result.hashes[hashKey(workload, kernel)] = meshHash(*mesh);
+        }
+    }
+    return result;
+}
+
+// Compares one workload's result against its baseline entries; returns false on a regression
+static bool check(const Workload &workload, const Result &result, const Options &options,
+                  const std::map<std::string, std::string> &expected) {
+    bool ok = true;
+
+    auto baselineValue = [&](const char *key, double &value) {
+        auto it = expected.find(key);
+        if (it == expected.end()) return false;
+        value = std::atof(it->second.c_str());
+        return value > 0;
+    };
+
+    double base = 0;
+#ifdef NDEBUG
+    if (!options.checkThroughput) {
+        std::printf("  throughput   %12.0f vertices/s   not compared: no --check-throughput\n", result.verticesPerSecond);
+    } else if (baselineValue("vertices_per_s", base)) {
+        double ratio = result.verticesPerSecond / base;
+        bool pass = ratio >= 1.0 - options.threshold;
+        std::printf("  throughput   %12.0f vertices/s   baseline %12.0f   %+6.1f%%   %s\n",
+                    result.verticesPerSecond, base, (ratio - 1) * 100, pass ? "ok" : "REGRESSED");
+        ok &= pass;
+    } else {
+        std::printf("  throughput   %12.0f vertices/s   no baseline\n", result.verticesPerSecond);
+    }
+#else
+    std::printf("  throughput   %12.0f vertices/s   not compared: unoptimized build\n", result.verticesPerSecond);
+#endif
+
+    if (!options.checkThroughput) {
+        std::printf("  peak RSS     %12ld KiB          not compared: no --check-throughput\n", result.peakRssKb);
+    } else if (baselineValue("peak_rss_kb", base)) {
+        double ratio = result.peakRssKb / base;
+        bool pass = ratio <= 1.0 + options.threshold;
+        std::printf("  peak RSS     %12ld KiB          baseline %12.0f   %+6.1f%%   %s\n",
+                    result.peakRssKb, base, (ratio - 1) * 100, pass ? "ok" : "REGRESSED");
+        ok &= pass;
+    } else {
+        std::printf("  peak RSS     %12ld KiB          no baseline\n", result.peakRssKb);
+    }
+
+    // Without a baseline hash nothing about the geometry would be checked, so that fails as well
+    for (const auto &[key, value] : result.hashes) {
+        auto hash = expected.find(key);
+        if (hash != expected.end()) {
+            bool pass = hash->second == value;
+            std::printf("  %-12s %s       baseline %s   %s\n", key.c_str(), value.c_str(), hash->second.c_str(),
+                        pass ? "ok" : "CHANGED");
+            ok &= pass;
+        } else {
+            std::printf("  %-12s %s       no baseline   MISSING\n", key.c_str(), value.c_str());
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        std::printf("%s: regression beyond %.0f%%, or changed or unrecorded geometry, against %s\n", workload.name,
+                    options.threshold * 100, options.baselinePath.c_str());
+    }
+    return ok;
+}
+
+static void printUsage(std::FILE *to) {
+    std::fprintf(to,
+        "usage: planet_perf --workload <name> --baseline FILE [options]\n"
+        "       planet_perf --check-kernels\n"
+        "\n"
+        "  --workload W        terrain-500 or sphere-256\n"
+        "  --baseline FILE     baseline to compare against (or update)\n"
+        "  --threshold T       allowed relative regression, e.g. 0.25 for 25%% (default 0.25)\n"
+        "  --runs N            minimum builds per workload; the best is compared (default 5)\n"
+        "  --min-time S        keep building for at least S seconds (default 1)\n"
+        "  --threads N         generation threads (default 1, for stable numbers)\n"
+        "  --check-throughput  also compare throughput and peak RSS, which only hold on the baseline's machine\n"
+        "  --update-baseline   write this run's results into the baseline instead of checking\n"
+        "  --check-kernels     compare every supported noise kernel with the scalar reference\n");
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(stdout);
+            return 0;
+        } else if (arg == "--check-throughput") {
+            options.checkThroughput = true;
+        } else if (arg == "--update-baseline") {
+            options.update = true;
+        } else if (arg == "--check-kernels") {
+            return checkKernels() ? 0 : 1;
+        } else if (arg == "--workload" && value) {
+            options.workload = argv[++i];
+        } else if (arg == "--baseline" && value) {
+            options.baselinePath = argv[++i];
+        } else if (arg == "--threshold" && value) {
+            options.threshold = std::atof(argv[++i]);
+        } else if (arg == "--runs" && value) {
+            options.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-time" && value) {
+            options.minTime = std::atof(argv[++i]);
+        } else if (arg == "--threads" && value) {
+            options.threads = std::max(0, std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "planet_perf: bad argument '%s'\n", arg.c_str());
+            printUsage(stderr);
+            return 2;
+        }
+    }
+    if (options.workload.empty() || options.baselinePath.empty()) {
+        printUsage(stderr);
+        return 2;
+    }
+
+    std::vector<Workload> all = workloads();
+    auto workload = std::find_if(all.begin(), all.end(), [&](const Workload &w) { return options.workload == w.name; });
+    if (workload == all.end()) {
+        std::fprintf(stderr, "planet_perf: unknown workload '%s'\n", options.workload.c_str());
+        return 2;
+    }
+
+    Baseline baseline;
+    if (!readBaseline(options.baselinePath, baseline) && !options.update) {
+        std::fprintf(stderr, "planet_perf: cannot read baseline '%s'\n", options.baselinePath.c_str());
+        return 1;
+    }
+    Result result = run(*workload, options);
+    if (!options.update) {
+        return check(*workload, result, options, baseline[workload->name]) ? 0 : 1;
+    }
+
+    // Hashes of kernels this machine lacks are kept, as they cannot be measured here
+    std::map<std::string, std::string> &entries = baseline[workload->name];
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.0f", result.verticesPerSecond);
+    entries["vertices_per_s"] = number;
+    entries["peak_rss_kb"] = std::to_string(result.peakRssKb);
+    if (!workload->noise) std::erase_if(entries, [](const auto &entry) { return entry.first.rfind("hash.", 0) == 0; });
+    for (const auto &[key, value] : result.hashes) entries[key] = value;
+    if (!writeBaseline(options.baselinePath, baseline)) {
+        std::fprintf(stderr, "planet_perf: cannot write baseline '%s'\n", options.baselinePath.c_str());
+        return 1;
+    }
+    std::printf("updated %s\n", options.baselinePath.c_str());
+    return 0;
+}
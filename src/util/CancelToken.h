@@ -0,0 +1,17 @@
+#pragma once
+
+#include <functional>
+
+// Cooperative cancellation for long-running generation.
+// Generators poll isCancelled() between rows/bands and return early once it turns true.
+class CancelToken
+{
+public:
+    CancelToken() = default;
+    explicit CancelToken(std::function<bool()> check) : m_check(std::move(check)) {}
+
+    bool isCancelled() const { return m_check && m_check(); }
+
+private:
+    std::function<bool()> m_check;
+};
@@ -0,0 +1,131 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+int resolveThreadCount(int requested) {
+    if (requested > 0) return requested;
+    return std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+namespace {
+
+// Worker threads shared by every parallelFor() call, started when first needed and kept until exit,
+// so a call costs a queue push and a wake-up per band rather than a thread start and join.
+class WorkerPool
+{
+public:
+    static WorkerPool &instance() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_wake.notify_all();
+        for (std::thread &worker : m_workers) worker.join();
+    }
+
+    // Runs band(0) .. band(bands - 1), band(0) on the calling thread, and returns once all have finished,
+    // rethrowing the first exception any of them threw
+    void run(int bands, const std::function<void(int)> &band) {
+        Job job{&band, bands - 1};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (int(m_workers.size()) < bands - 1) m_workers.emplace_back(&WorkerPool::work, this);
+            for (int b = 1; b < bands; b++) m_tasks.push_back({&job, b});
+        }
+        m_wake.notify_all();
+
+        std::exception_ptr error = capture(band, 0);
+
+        // Take on queued bands while waiting, so a parallelFor() inside a band cannot starve its caller
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (job.remaining > 0) {
+            if (m_tasks.empty()) {
+                m_done.wait(lock);
+                continue;
+            }
+            Task task = m_tasks.front();
+            m_tasks.pop_front();
+            execute(task, lock);
+        }
+        if (!error) error = job.error;
+        lock.unlock();
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    struct Job
+    {
+        const std::function<void(int)> *band;
+        int remaining; // bands queued or running, other than the caller's
+        std::exception_ptr error; // first thrown by those bands
+    };
+    struct Task
+    {
+        Job *job;
+        int band;
+    };
+
+    static std::exception_ptr capture(const std::function<void(int)> &band, int b) {
+        try {
+            band(b);
+        } catch (...) {
+            return std::current_exception();
+        }
+        return nullptr;
+    }
+
+    // Runs `task` with the lock released; an exception is kept for the job's caller, since letting it
+    // leave a worker would terminate the process
+    void execute(const Task &task, std::unique_lock<std::mutex> &lock) {
+        lock.unlock();
+        std::exception_ptr error = capture(*task.job->band, task.band);
+        lock.lock();
+        if (error && !task.job->error) task.job->error = error;
+        if (--task.job->remaining == 0) m_done.notify_all();
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_quit || !m_tasks.empty(); });
+            if (m_quit) return;
+            Task task = m_tasks.front();
+            m_tasks.pop_front();
+            execute(task, lock);
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // tasks queued, or quitting
+    std::condition_variable m_done; // a job's last band finished
+    std::deque<Task> m_tasks;
+    std::vector<std::thread> m_workers;
+    bool m_quit = false;
+};
+
+} // namespace
+
+void parallelFor(int count, int threads, const std::function<void(int begin, int end)> &body) {
+    if (count <= 0) return;
+
+    int bands = std::min(resolveThreadCount(threads), count);
+    if (bands == 1) {
+        body(0, count);
+        return;
+    }
+
+    auto bandStart = [&](int b) { return int(int64_t(count) * b / bands); };
+    WorkerPool::instance().run(bands, [&](int b) { body(bandStart(b), bandStart(b + 1)); });
+}
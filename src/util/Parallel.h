@@ -0,0 +1,13 @@
+#pragma once
+
+#include <functional>
+
+// Number of threads to use for a requested count; 0 means one per hardware thread
+int resolveThreadCount(int requested);
+
+// Splits [0, count) into `threads` contiguous bands and runs body(begin, end) for each, concurrently:
+// the calling thread takes the first band and a pool of workers, kept between calls, the others.
+// The split only decides which thread computes which indices, so as long as every index is computed
+// independently of the others the result is bit-identical for any thread count. If bands throw, the
+// first exception is rethrown on the calling thread once every band has finished.
+void parallelFor(int count, int threads, const std::function<void(int begin, int end)> &body);
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <QMatrix4x4>
+#include <QOpenGLFunctions_4_1_Core>
+
+#include "shapes/VertexFormat.h"
+
+inline GLenum glComponentType(ComponentType type)
+{
+    switch (type) {
+    case ComponentType::Float: return GL_FLOAT;
+    case ComponentType::Int8: return GL_BYTE;
+    case ComponentType::UInt8: return GL_UNSIGNED_BYTE;
+    case ComponentType::Int16: return GL_SHORT;
+    case ComponentType::UInt16: return GL_UNSIGNED_SHORT;
+    case ComponentType::Int32: return GL_INT;
+    case ComponentType::UInt32: return GL_UNSIGNED_INT;
+    }
+    return GL_FLOAT;
+}
+
+// Points the bound VAO's attributes at the bound GL_ARRAY_BUFFER as laid out by `Format`,
+// disabling any left over from a wider format
+template <class Format>
+void setVertexAttributes(QOpenGLFunctions_4_1_Core *gl)
+{
+    static constexpr int kMaxAttributes = 4;
+    static_assert(Format::attributeCount <= kMaxAttributes, "raise kMaxAttributes");
+    for (const AttributeLayout &attribute : Format::layout) {
+        gl->glEnableVertexAttribArray(attribute.location);
+        gl->glVertexAttribPointer(attribute.location, attribute.components, glComponentType(attribute.type),
+                                  attribute.normalized ? GL_TRUE : GL_FALSE, GLsizei(Format::stride),
+                                  reinterpret_cast<void *>(attribute.offset));
+    }
+    for (int location = Format::attributeCount; location < kMaxAttributes; location++) {
+        gl->glDisableVertexAttribArray(location);
+    }
+}
+
+inline QMatrix4x4 toQMatrix(const glm::mat4 &m)
+{
+    // QMatrix4x4 takes its constructor values row by row; glm is column-major
+    return QMatrix4x4(glm::value_ptr(glm::transpose(m)));
+}
+
+// GLSL shared by the viewer's shaders. Each goes after the version line and before the code that calls it.
+
+// vec3 octDecode(vec2): the unit normal encodeOctNormal() packed into two components
+inline constexpr const char *octDecodeSource =
+    "vec3 octDecode(vec2 o) {\n"
+    "   vec3 n = vec3(o, 1.0 - abs(o.x) - abs(o.y));\n"
+    "   if (n.z < 0.0) n.xy = (1.0 - abs(o.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(o, vec2(0.0)));\n"
+    "   return normalize(n);\n"
+    "}\n";
+
+// vec3 shade(vec3 normal, vec3 toLight): the shapes' colour, lit from the unit direction `toLight`
+inline constexpr const char *shadeSource =
+    "vec3 shade(vec3 normal, vec3 toLight) {\n"
+    "   float NL = max(dot(normalize(normal), toLight), 0.0);\n"
+    "   vec3 color = vec3(1.0, 0.78, 0.0);\n"
+    "   return clamp(color * 0.2 + color * 0.8 * NL, 0.0, 1.0);\n"
+    "}\n";
+
+// Fragment shader lit by a point light at `lightPos`, in eye coordinates; black for the wireframe pass.
+// Needs shadeSource.
+inline constexpr const char *pointLitFragmentSource =
+    "in vec3 vert;\n"
+    "in vec3 vertNormal;\n"
+    "out vec4 fragColor;\n"
+    "uniform vec3 lightPos;\n"
+    "uniform bool wireframe;\n"
+    "void main() {\n"
+    "   if (wireframe) { fragColor = vec4(vec3(0.0), 1.0); return; }\n"
+    "   fragColor = vec4(shade(vertNormal, normalize(lightPos - vert)), 1.0);\n"
+    "}\n";
+
+// The same lit by a distant sun in the unit direction `lightDir`, in eye coordinates
+inline constexpr const char *sunLitFragmentSource =
+    "in vec3 vertNormal;\n"
+    "out vec4 fragColor;\n"
+    "uniform vec3 lightDir;\n"
+    "uniform bool wireframe;\n"
+    "void main() {\n"
+    "   if (wireframe) { fragColor = vec4(vec3(0.0), 1.0); return; }\n"
+    "   fragColor = vec4(shade(vertNormal, lightDir), 1.0);\n"
+    "}\n";
+
+// A GLSL 3.30 shader: the version line, then `parts` in order
+inline std::string glslSource(std::initializer_list<const char *> parts)
+{
+    std::string source = "#version 330 core\n";
+    for (const char *part : parts) source += part;
+    return source;
+}